@@ -0,0 +1,523 @@
+//
+// Benchmark of the solver over the puzzles of the data folder
+//
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <filesystem>
+#include <dirent.h>
+#include <malloc.h>
+#include <sys/resource.h>
+#include "Map.hpp"
+#include "State.hpp"
+#include "Solver.hpp"
+#include "FreeRuns.hpp"
+#include "DistanceTable.hpp"
+
+namespace {
+
+std::atomic<size_t> allocationCount(0);
+std::atomic<size_t> liveBytes(0);
+std::atomic<size_t> peakBytes(0);
+
+/**
+ * @brief recordAllocation counts an allocation, and updates the peak of heap memory
+ * @param size the size of the allocated block
+ */
+void recordAllocation(size_t size)
+{
+    allocationCount++;
+    size_t live = liveBytes += size;
+    size_t peak = peakBytes;
+    while(live > peak && !peakBytes.compare_exchange_weak(peak, live)){}
+}
+
+}
+
+void *operator new(size_t size)
+{
+    void *data = std::malloc(size ? size : 1);
+    if(!data) throw std::bad_alloc();
+    recordAllocation(malloc_usable_size(data));
+    return data;
+}
+
+void operator delete(void *data) noexcept
+{
+    if(!data) return;
+    liveBytes -= malloc_usable_size(data);
+    std::free(data);
+}
+
+void operator delete(void *data, size_t) noexcept
+{
+    operator delete(data);
+}
+
+namespace {
+
+/**
+ * @brief The Puzzle struct a puzzle to benchmark : the map as read, with
+ * its cars, given to the Solver, and the board without the cars with the
+ * starting state extracted from it
+ */
+struct Puzzle{
+    std::string name;
+    Map parsed;
+    Map map;
+    State start;
+};
+
+/**
+ * @brief The Measure struct the result of the benchmark of a puzzle
+ */
+struct Measure{
+    std::string name;
+    int moves;
+    size_t explored;
+    double wallMs;
+    double minWallMs;
+    size_t allocations;
+    size_t peakHeapBytes;
+    long peakRssKb;
+};
+
+/**
+ * @brief The Options struct the parameters of the benchmark
+ */
+struct Options{
+    std::string dataFolder = "data";
+    std::string search = "bfs";
+    SolverOptions solver;
+    std::string output;
+    std::string baseline;
+    int runs = 3;
+    int generated = 4;
+    int threads = 4;
+    unsigned seed = 42;
+    double threshold = 10;
+    bool selfCheck = false;
+};
+
+/**
+ * @brief MAX_GENERATION_ATTEMPTS number of random layouts tried
+ * for a generated puzzle before giving up
+ */
+const int MAX_GENERATION_ATTEMPTS = 1000;
+
+/**
+ * @brief The SearchName struct a search the benchmark can run, by its name
+ */
+struct SearchName{
+    const char *name;
+    SearchAlgorithm algorithm;
+};
+
+/**
+ * @brief SEARCHES the searches the benchmark can run, bfs being the generic
+ * breadth-first search and fixed the one compiled for the size of the map
+ */
+const SearchName SEARCHES[] = {
+    {"bfs", GENERIC_BREADTH_FIRST},
+    {"fixed", BREADTH_FIRST},
+    {"parallel", PARALLEL_BREADTH_FIRST},
+    {"frontier", FRONTIER},
+    {"ranked", RANKED},
+    {"external", EXTERNAL},
+    {"astar", A_STAR},
+    {"ida", IDA_STAR}
+};
+
+/**
+ * @brief peakRssKb peak resident memory of the process
+ * @return the peak resident memory in kilobytes
+ */
+long peakRssKb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief loadPuzzles reads all the rushhour*.txt files of the given folder
+ * @param folder the folder to read
+ * @return the puzzles, sorted by name
+ */
+std::vector<Puzzle> loadPuzzles(const std::string &folder)
+{
+    std::vector<std::string> names;
+    if(DIR *dir = opendir(folder.c_str())){
+        while(dirent *entry = readdir(dir)){
+            std::string name = entry->d_name;
+            if(name.compare(0, 8, "rushhour") == 0 && name.size() > 4 &&
+                    name.compare(name.size() - 4, 4, ".txt") == 0){
+                names.push_back(name);
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+
+    std::vector<Puzzle> puzzles;
+    for(const std::string &name : names){
+        try{
+            Map parsed = parseFile(folder + "/" + name);
+            Puzzle puzzle{name.substr(0, name.size() - 4), parsed, parsed, State()};
+            puzzle.start.extractFrom(puzzle.map);
+            puzzles.push_back(puzzle);
+        } catch(const std::exception &e){
+            std::cerr << name << " : skipped, " << e.what() << "\n";
+        }
+    }
+    return puzzles;
+}
+
+/**
+ * @brief generatePuzzle places random cars on a square map, with the exit
+ * on the right of the main car's row, until a layout needing at least 8 moves
+ * is found, throws an exception after MAX_GENERATION_ATTEMPTS layouts
+ * @param size the size of the map (including borders)
+ * @param carCount the number of cars (including the main car)
+ * @param seed the seed of the layout, the same seed always gives the same puzzle
+ * @return the puzzle generated
+ */
+Puzzle generatePuzzle(int size, int carCount, unsigned seed)
+{
+    uint64_t random = seed * 0x9E3779B97F4A7C15ull + 1;
+    auto next = [&random](int bound){
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        return static_cast<int>(random % bound);
+    };
+
+    int exitRow = size / 2 - 1;
+    for(int layout = 0; layout < MAX_GENERATION_ATTEMPTS; ++layout){
+        std::vector<std::string> rows(size, std::string(size, ' '));
+        for(int i = 0; i < size; ++i){
+            rows[0][i] = rows[size - 1][i] = rows[i][0] = rows[i][size - 1] = 'x';
+        }
+        rows[exitRow][size - 1] = 'z';
+        rows[exitRow][1] = rows[exitRow][2] = 'a';
+
+        for(int car = 1; car < carCount; ++car){
+            for(int attempt = 0; attempt < 100; ++attempt){
+                bool vertical = next(2);
+                int length = next(4) == 0 ? 3 : 2;
+                int x = 1 + next(size - 2 - (vertical ? 0 : length - 1));
+                int y = 1 + next(size - 2 - (vertical ? length - 1 : 0));
+                if(!vertical && y == exitRow) continue;
+                bool free = true;
+                for(int i = 0; i < length; ++i){
+                    free = free && rows[vertical ? y + i : y][vertical ? x : x + i] == ' ';
+                }
+                if(!free) continue;
+                for(int i = 0; i < length; ++i){
+                    rows[vertical ? y + i : y][vertical ? x : x + i] = static_cast<char>('a' + car);
+                }
+                break;
+            }
+        }
+
+        Puzzle puzzle{"generated" + std::to_string(size) + "x" + std::to_string(size) + "_" + std::to_string(seed),
+                      Map(size, size), Map(size, size), State()};
+        for(int y = 0; y < size; ++y){
+            for(int x = 0; x < size; ++x) puzzle.map.setValue(x, y, rows[y][x]);
+        }
+        puzzle.parsed = puzzle.map;
+        puzzle.start.extractFrom(puzzle.map);
+        Map board = puzzle.map;
+        if(aStarSearch(board, puzzle.start, BLOCKERS_OF_BLOCKERS).moves() >= 8) return puzzle;
+    }
+    throw std::runtime_error("No puzzle of " + std::to_string(carCount) + " cars needing 8 moves found in " +
+                             std::to_string(MAX_GENERATION_ATTEMPTS) + " layouts of " +
+                             std::to_string(size) + "x" + std::to_string(size) + " (seed " + std::to_string(seed) + ")");
+}
+
+/**
+ * @brief runSearch solves the puzzle with the search to benchmark, on
+ * a new Solver so that every run allocates all the memory of its search
+ * @param puzzle the puzzle to solve
+ * @param options the benchmark parameters
+ * @return the result of the search
+ */
+SolverResult runSearch(const Puzzle &puzzle, const Options &options)
+{
+    Solver solver;
+    return solver.solve(puzzle.parsed, options.solver);
+}
+
+/**
+ * @brief measure runs the search several times on the puzzle
+ * @param puzzle the puzzle to solve
+ * @param options the benchmark parameters
+ * @return the median wall time, and the work and memory of the last run
+ */
+Measure measure(const Puzzle &puzzle, const Options &options)
+{
+    Measure result{puzzle.name, -1, 0, 0, 0, 0, 0, 0};
+    std::vector<double> times;
+    for(int run = 0; run < options.runs; ++run){
+        size_t allocationsBefore = allocationCount;
+        size_t liveBefore = liveBytes;
+        peakBytes = liveBefore;
+
+        auto start = std::chrono::steady_clock::now();
+        SolverResult search = runSearch(puzzle, options);
+        auto end = std::chrono::steady_clock::now();
+
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        result.moves = search.depth;
+        result.explored = search.explored;
+        result.allocations = allocationCount - allocationsBefore;
+        result.peakHeapBytes = peakBytes - liveBefore;
+    }
+    std::sort(times.begin(), times.end());
+    result.wallMs = times[times.size() / 2];
+    result.minWallMs = times.front();
+    result.peakRssKb = peakRssKb();
+    return result;
+}
+
+/**
+ * @brief checkKernels runs every version of freeRuns the processor supports
+ * on every state reachable from the puzzle, and compares their distances
+ * with each other and with Bitboard::freeBefore and Bitboard::freeAfter
+ * @param puzzle the puzzle to check, its map must fit in 64 bits
+ * @param kernels the names of the versions to run
+ * @return the number of states where a version disagrees
+ */
+size_t checkKernels(const Puzzle &puzzle, const std::vector<std::string> &kernels)
+{
+    Map map = puzzle.map;
+    DistanceTable cluster(map, puzzle.start);
+    const int count = puzzle.start.carCount();
+
+    // The tables of the cars, built as FixedSearch builds them for this size of map
+    const int line = std::max(map.width(), map.height());
+    std::vector<uint64_t> behind(count * line);
+    std::vector<uint64_t> ahead(count * line);
+    RunTable table;
+    buildRunTable(map, puzzle.start, line, behind.data(), ahead.data(), table);
+
+    size_t mismatches = 0;
+    std::array<int8, MAX_CARS> origins;
+    for(StateKey key : cluster.keys()){
+        State state = State::fromKey(key, map.encoder());
+        map.placeState(state);
+        const Bitboard &board = map.board();
+        origins.fill(1);
+        for(int c = 0; c < count; ++c) origins[c] = state.car(c).origin;
+
+        bool same = true;
+        for(const std::string &kernel : kernels){
+            FreeRuns runs;
+            freeRunsWith(kernel, table, static_cast<uint64_t>(board.rows()), static_cast<uint64_t>(board.columns()),
+                         origins.data(), runs);
+            for(int c = 0; c < count; ++c){
+                const CarTrack &track = map.track(state.car(c).code);
+                same = same && runs.before[c] == board.freeBefore(track, origins[c]) &&
+                        runs.after[c] == board.freeAfter(track, origins[c]);
+            }
+        }
+        if(!same) mismatches++;
+    }
+    return mismatches;
+}
+
+/**
+ * @brief selfCheck checks the versions of freeRuns on all the puzzles
+ * whose map fits in 64 bits
+ * @param puzzles the puzzles to check
+ * @return wether all the versions agree everywhere
+ */
+bool selfCheck(const std::vector<Puzzle> &puzzles)
+{
+    std::vector<std::string> kernels = freeRunsKernels();
+    std::cerr << "Kernels :";
+    for(const std::string &kernel : kernels) std::cerr << " " << kernel;
+    std::cerr << "\n";
+
+    bool agree = true;
+    for(const Puzzle &puzzle : puzzles){
+        if(puzzle.map.width() * puzzle.map.height() > 64){
+            std::cerr << puzzle.name << " : skipped, more than 64 cells\n";
+            continue;
+        }
+        size_t mismatches = checkKernels(puzzle, kernels);
+        std::cerr << puzzle.name << " : " << (mismatches ? std::to_string(mismatches) + " states differ" : "ok") << "\n";
+        agree = agree && !mismatches;
+    }
+    return agree;
+}
+
+/**
+ * @brief readBaseline extracts the wall time of every puzzle of a previous report
+ * @param path the report to read
+ * @param names the names of the puzzles found
+ * @param times the wall time of each puzzle found
+ * @return false if the file can't be read
+ */
+bool readBaseline(const std::string &path, std::vector<std::string> &names, std::vector<double> &times)
+{
+    std::ifstream file(path);
+    if(!file.is_open()) return false;
+    std::stringstream content;
+    content << file.rdbuf();
+    std::string text = content.str();
+
+    const std::string nameField = "\"name\": \"";
+    const std::string timeField = "\"wall_ms\": ";
+    size_t position = 0;
+    while((position = text.find(nameField, position)) != std::string::npos){
+        position += nameField.size();
+        size_t nameEnd = text.find('"', position);
+        size_t time = text.find(timeField, nameEnd);
+        if(nameEnd == std::string::npos || time == std::string::npos) break;
+        names.push_back(text.substr(position, nameEnd - position));
+        times.push_back(std::atof(text.c_str() + time + timeField.size()));
+        position = nameEnd;
+    }
+    return true;
+}
+
+/**
+ * @brief parseOptions reads the command line
+ * @param argc number of arguments
+ * @param argv the arguments
+ * @param options the options to fill
+ * @return false if an argument is unknown
+ */
+bool parseOptions(int argc, char **argv, Options &options)
+{
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(arg == "--data" && hasValue) options.dataFolder = argv[++i];
+        else if(arg == "--search" && hasValue) options.search = argv[++i];
+        else if(arg == "--out" && hasValue) options.output = argv[++i];
+        else if(arg == "--baseline" && hasValue) options.baseline = argv[++i];
+        else if(arg == "--runs" && hasValue) options.runs = std::max(1, std::atoi(argv[++i]));
+        else if(arg == "--generated" && hasValue) options.generated = std::max(0, std::atoi(argv[++i]));
+        else if(arg == "--threads" && hasValue) options.threads = std::max(1, std::atoi(argv[++i]));
+        else if(arg == "--seed" && hasValue) options.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if(arg == "--threshold" && hasValue) options.threshold = std::atof(argv[++i]);
+        else if(arg == "--external-dir" && hasValue) options.solver.externalDirectory = argv[++i];
+        else if(arg == "--self-check") options.selfCheck = true;
+        else return false;
+    }
+
+    const SearchName *search = std::find_if(std::begin(SEARCHES), std::end(SEARCHES), [&options](const SearchName &s){
+        return options.search == s.name;
+    });
+    if(search == std::end(SEARCHES)){
+        std::cerr << "Unknown search " << options.search << "\n";
+        return false;
+    }
+    options.solver.algorithm = search->algorithm;
+    options.solver.threadCount = options.threads;
+    if(options.solver.externalDirectory.empty()){
+        options.solver.externalDirectory = std::filesystem::temp_directory_path().string();
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if(!parseOptions(argc, argv, options)){
+        std::cerr << "Usage : " << argv[0] << " [--data FOLDER] [--search bfs|fixed|parallel|frontier|ranked|external|astar|ida]"
+                  << " [--threads N] [--external-dir DIR] [--runs N] [--generated N] [--seed N]"
+                  << " [--out FILE] [--baseline FILE] [--threshold PERCENT] [--self-check]\n";
+        return -1;
+    }
+
+    std::vector<Puzzle> puzzles = loadPuzzles(options.dataFolder);
+    if(options.selfCheck) return selfCheck(puzzles) ? 0 : 1;
+    std::vector<Measure> measures;
+    try{
+        for(int i = 0; i < options.generated; ++i){
+            puzzles.push_back(generatePuzzle(10, 13, options.seed + i));
+        }
+        for(const Puzzle &puzzle : puzzles){
+            measures.push_back(measure(puzzle, options));
+            std::cerr << puzzle.name << " : " << measures.back().wallMs << " ms\n";
+        }
+    } catch(const std::exception &e){
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> baselineNames;
+    std::vector<double> baselineTimes;
+    if(!options.baseline.empty() && !readBaseline(options.baseline, baselineNames, baselineTimes)){
+        std::cerr << "Can't read the baseline " << options.baseline << std::endl;
+        return -1;
+    }
+
+    std::stringstream json;
+    json << "{\n";
+    json << "  \"search\": \"" << options.search << "\",\n";
+    json << "  \"runs\": " << options.runs << ",\n";
+    json << "  \"puzzles\": [\n";
+    std::vector<std::string> regressions;
+    for(size_t i = 0; i < measures.size(); ++i){
+        const Measure &m = measures[i];
+        double seconds = m.wallMs / 1000;
+        json << "    {\"name\": \"" << m.name << "\""
+             << ", \"moves\": " << m.moves
+             << ", \"explored\": " << m.explored
+             << ", \"wall_ms\": " << m.wallMs
+             << ", \"min_wall_ms\": " << m.minWallMs
+             << ", \"states_per_sec\": " << (seconds > 0 ? m.explored / seconds : 0)
+             << ", \"allocations\": " << m.allocations
+             << ", \"allocations_per_state\": " << (m.explored ? double(m.allocations) / m.explored : 0)
+             << ", \"peak_heap_bytes\": " << m.peakHeapBytes
+             << ", \"bytes_per_state\": " << (m.explored ? double(m.peakHeapBytes) / m.explored : 0)
+             << ", \"peak_rss_kb\": " << m.peakRssKb;
+
+        auto found = std::find(baselineNames.begin(), baselineNames.end(), m.name);
+        if(found != baselineNames.end()){
+            double before = baselineTimes[found - baselineNames.begin()];
+            double change = before > 0 ? (m.wallMs - before) * 100 / before : 0;
+            json << ", \"baseline_wall_ms\": " << before << ", \"change_percent\": " << change;
+            if(change > options.threshold) regressions.push_back(m.name);
+        }
+        json << "}" << (i + 1 < measures.size() ? "," : "") << "\n";
+    }
+    json << "  ]";
+    if(!options.baseline.empty()){
+        json << ",\n  \"threshold_percent\": " << options.threshold << ",\n  \"regressions\": [";
+        for(size_t i = 0; i < regressions.size(); ++i){
+            json << (i ? ", " : "") << "\"" << regressions[i] << "\"";
+        }
+        json << "]";
+    }
+    json << "\n}\n";
+
+    if(options.output.empty()){
+        std::cout << json.str();
+    } else {
+        std::ofstream file(options.output);
+        file << json.str();
+    }
+
+    for(const std::string &name : regressions){
+        std::cerr << "Regression on " << name << std::endl;
+    }
+    return regressions.empty() ? 0 : 1;
+}
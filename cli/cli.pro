@@ -0,0 +1,15 @@
+
+QT              -= gui core
+CONFIG          += c++17 thread
+QMAKE_CXXFLAGS  += -std=c++17
+TARGET          = rushhour
+
+INCLUDEPATH     += ../src
+
+# Same switch as src/rushhour.pri, the headers must agree with the library
+!nostats: DEFINES += RUSHHOUR_STATS
+
+LIBS            += -L$$OUT_PWD/../src -lrushhour
+PRE_TARGETDEPS  += $$OUT_PWD/../src/librushhour.a
+
+SOURCES += main.cpp
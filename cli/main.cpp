@@ -0,0 +1,336 @@
+//
+// Created by Azarias Boutin
+//
+
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include "State.hpp"
+#include "Map.hpp"
+#include "Solver.hpp"
+#include "Batch.hpp"
+#include "Server.hpp"
+#include "PuzzlePack.hpp"
+#include "Generator.hpp"
+#include "DistanceTable.hpp"
+#include "SolutionDatabase.hpp"
+#include "SearchStats.hpp"
+#include "HintSession.hpp"
+
+/**
+ * @brief printUsage writes the options of the program
+ * @param program the name the program was launched with
+ */
+void printUsage(const char *program)
+{
+    std::cerr << "Usage : " << program << " [--threads N | --generic | --frontier | --ranked [--memory-mb MB] | --external DIR [--memory-mb MB] | --astar | --ida [--tt-mb MB] | --cluster | --build-db FILE | --db FILE] [--heuristic blocking|blockers] [--stats FILE] [--trace FILE] puzzle.txt\n";
+    std::cerr << "       " << program << " --batch [--threads N] [--generic | --frontier | --ranked | --external DIR | --astar | --ida] [--format jsonl|csv] [--out FILE] puzzle.txt|pack|directory...\n";
+    std::cerr << "       " << program << " --write-pack FILE puzzle.txt|pack|directory...\n";
+    std::cerr << "       " << program << " --serve | --socket PATH [--threads N] [--generic | --frontier | --ranked | --external DIR | --astar | --ida]\n";
+    std::cerr << "       " << program << " --generate FILE [--cars N] [--size N] [--min-moves N] [--count N] [--threads N]\n";
+    std::cerr << "       " << program << " --hints GAMES [--heuristic blocking|blockers] puzzle.txt\n";
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> fileNames;
+    SolverOptions options;
+    int threadCount = 1;
+    bool threadsGiven = false;
+    bool cluster = false;
+    bool batch = false;
+    BatchFormat batchFormat = JSON_LINES;
+    std::string outFile;
+    bool serve = false;
+    std::string socketPath;
+    std::string packFile;
+    std::string generateFile;
+    GeneratorOptions generator;
+    std::string buildDatabase;
+    std::string database;
+    std::string statsFile;
+    std::string traceFile;
+    int hintGames = 0;
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--astar"){
+            options.algorithm = A_STAR;
+        } else if(arg == "--external" && i + 1 < argc){
+            options.algorithm = EXTERNAL;
+            options.externalDirectory = argv[++i];
+        } else if(arg == "--memory-mb" && i + 1 < argc){
+            options.memoryMegabytes = std::max(1, std::atoi(argv[++i]));
+        } else if(arg == "--serve"){
+            serve = true;
+        } else if(arg == "--socket" && i + 1 < argc){
+            socketPath = argv[++i];
+        } else if(arg == "--write-pack" && i + 1 < argc){
+            packFile = argv[++i];
+        } else if(arg == "--generate" && i + 1 < argc){
+            generateFile = argv[++i];
+        } else if(arg == "--cars" && i + 1 < argc){
+            generator.carCount = std::atoi(argv[++i]);
+        } else if(arg == "--size" && i + 1 < argc){
+            generator.size = std::atoi(argv[++i]);
+        } else if(arg == "--min-moves" && i + 1 < argc){
+            generator.minMoves = std::atoi(argv[++i]);
+        } else if(arg == "--count" && i + 1 < argc){
+            generator.count = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if(arg == "--batch"){
+            batch = true;
+        } else if(arg == "--format" && i + 1 < argc){
+            std::string format = argv[++i];
+            if(format != "csv" && format != "jsonl"){
+                std::cerr << "Unknown format " << format << "\n";
+                printUsage(argv[0]);
+                return -1;
+            }
+            batchFormat = format == "csv" ? CSV : JSON_LINES;
+        } else if(arg == "--out" && i + 1 < argc){
+            outFile = argv[++i];
+        } else if(arg == "--ranked"){
+            options.algorithm = RANKED;
+        } else if(arg == "--frontier"){
+            options.algorithm = FRONTIER;
+        } else if(arg == "--generic"){
+            options.algorithm = GENERIC_BREADTH_FIRST;
+        } else if(arg == "--cluster"){
+            cluster = true;
+        } else if(arg == "--build-db" && i + 1 < argc){
+            buildDatabase = argv[++i];
+        } else if(arg == "--db" && i + 1 < argc){
+            database = argv[++i];
+        } else if(arg == "--stats" && i + 1 < argc){
+            statsFile = argv[++i];
+        } else if(arg == "--trace" && i + 1 < argc){
+            traceFile = argv[++i];
+        } else if(arg == "--hints" && i + 1 < argc){
+            hintGames = std::max(1, std::atoi(argv[++i]));
+        } else if(arg == "--ida"){
+            options.algorithm = IDA_STAR;
+        } else if(arg == "--tt-mb" && i + 1 < argc){
+            options.tableMegabytes = std::max(1, std::atoi(argv[++i]));
+        } else if(arg == "--heuristic" && i + 1 < argc){
+            std::string heuristic = argv[++i];
+            if(heuristic != "blocking" && heuristic != "blockers"){
+                std::cerr << "Unknown heuristic " << heuristic << "\n";
+                printUsage(argv[0]);
+                return -1;
+            }
+            options.heuristic = heuristic == "blocking" ? BLOCKING_CARS : BLOCKERS_OF_BLOCKERS;
+        } else if(arg == "--threads" && i + 1 < argc){
+            threadCount = std::atoi(argv[++i]);
+            threadsGiven = true;
+            if(threadCount <= 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+            generator.threadCount = threadCount;
+        } else {
+            fileNames.push_back(arg);
+        }
+    }
+    if(!socketPath.empty()){
+        try{
+            serveSocket(socketPath, threadCount, options);
+        } catch(const std::exception &e){
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+    if(!generateFile.empty()){
+        try{
+            GenerationReport report = generatePuzzles(generator);
+            std::ofstream out(generateFile);
+            writePuzzles(out, report.puzzles);
+            if(!out) throw std::runtime_error("Can't write the puzzles to " + generateFile);
+            std::cout << report.clusters << " clusters solved (" << report.layouts << " placements of "
+                      << report.trackSets << " sets of tracks) in " << report.seconds << " seconds, "
+                      << report.clusters / std::max(report.seconds, 1e-9) << " clusters per second\n";
+            std::cout << report.puzzles.size() << " puzzles written to " << generateFile;
+            if(!report.puzzles.empty()) std::cout << ", the hardest in " << report.puzzles.front().moves << " moves";
+            std::cout << "\n";
+        } catch(const std::exception &e){
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+    if(serve){
+        std::ios::sync_with_stdio(false);
+        PuzzleServer server(options);
+        server.serve(std::cin, std::cout);
+        return 0;
+    }
+    if(fileNames.empty()){
+        std::cerr << "Must pass filename in parameter\n";
+        printUsage(argv[0]);
+        return -1;
+    }
+
+    if(!packFile.empty()){
+        try{
+            size_t count = PuzzlePack::writeBinary(packFile, listPuzzles(fileNames));
+            std::cout << count << " puzzles written to " << packFile << "\n";
+        } catch(const std::exception &e){
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    if(batch){
+        // The puzzles are independent, all the cores solve them unless told otherwise
+        if(!threadsGiven) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        size_t failed = 0;
+        try{
+            if(outFile.empty()){
+                failed = solveBatch(listPuzzles(fileNames), threadCount, options, std::cout, batchFormat);
+            } else {
+                std::ofstream out(outFile);
+                if(!out) throw std::runtime_error("Can't write the results to " + outFile);
+                failed = solveBatch(listPuzzles(fileNames), threadCount, options, out, batchFormat);
+                out.close();
+                if(!out) throw std::runtime_error("Can't write the results to " + outFile);
+            }
+        } catch(const std::exception &e){
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        return failed ? 1 : 0;
+    }
+
+    Map m(0, 0);
+    try{
+        m = parseFile(fileNames.back());
+        std::cout << "Map width = " << m.width() << ", height = " << m.height() << std::endl;
+    } catch(const std::exception &e){
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    if(hintGames > 0){
+        try{
+            HintReplay replay = replayHints(m, hintGames, 1, options.heuristic);
+            std::cout << replay.positions << " positions of " << hintGames << " games answered in "
+                      << replay.hintSeconds << " seconds (" << replay.lookups << " lookups), "
+                      << replay.searchSeconds << " seconds for the breadth-first search\n";
+            std::cout << replay.mismatches << " hints differ from the breadth-first search\n";
+            return replay.mismatches ? 1 : 0;
+        } catch(const std::exception &e){
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    options.recordStats = !statsFile.empty() || !traceFile.empty();
+#ifndef RUSHHOUR_STATS
+    if(options.recordStats) std::cerr << "Built without RUSHHOUR_STATS, the statistics will be empty\n";
+#endif
+    if(threadCount > 1 && options.algorithm == BREADTH_FIRST) options.algorithm = PARALLEL_BREADTH_FIRST;
+    options.threadCount = threadCount;
+
+    // The databases are read (or built) here, the searches are left to the Solver
+    SolverResult result;
+    Solver solver;
+    bool treeSearch = false;
+    try{
+        if(!database.empty() || cluster || !buildDatabase.empty()){
+            State first;
+            first.extractFrom(m);
+            if(options.recordStats) result.stats.activate();
+            auto start = std::chrono::steady_clock::now();
+            if(!database.empty()){
+                SolutionDatabase db;
+                if(!db.open(database)){
+                    std::cerr << "Can't open the database " << database << std::endl;
+                    return -1;
+                }
+                if(db.fingerprint() != m.fingerprint()){
+                    std::cerr << "The database " << database << " was built for another map" << std::endl;
+                    return -1;
+                }
+                // The distance of the first state bounds the walk, and a move
+                // leaving the board stops it, in case the file is corrupt
+                DatabaseEntry entry;
+                State current = first;
+                int stepsLeft = -1;
+                while(db.lookup(current.key(m.encoder()), entry) && entry.distance != DistanceTable::NO_SOLUTION){
+                    if(stepsLeft < 0) stepsLeft = entry.distance;
+                    result.path.push_back(current);
+                    if(entry.car == SolutionDatabase::NO_MOVE){
+                        result.found = true;
+                        break;
+                    }
+                    if(stepsLeft-- == 0 || entry.car >= current.carCount()) break;
+                    int origin = current.car(entry.car).origin + entry.move;
+                    if(origin < 1 || origin > m.encoder().originCount(entry.car)) break;
+                    current.play(Move(entry.car, entry.move));
+                }
+            } else {
+                DistanceTable table(m, first);
+                std::cout << "Cluster of " << table.size() << " states, "
+                          << table.goalCount() << " solved states\n";
+                std::cout << "Hardest state of the cluster : " << table.maxDistance() << " moves\n";
+                if(!buildDatabase.empty()){
+                    SolutionDatabase::write(buildDatabase, m, table);
+                    std::cout << "Database written to " << buildDatabase << "\n";
+                }
+                result.path = table.solution(m, first);
+                result.found = !result.path.empty();
+                result.explored = table.size();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            result.seconds = elapsed.count();
+            result.stats.deactivate();
+            if(result.found) result.depth = static_cast<int>(result.path.size()) - 1;
+        } else {
+            result = solver.solve(m, options);
+            m = solver.board();
+            treeSearch = result.algorithm == BREADTH_FIRST || result.algorithm == GENERIC_BREADTH_FIRST ||
+                    result.algorithm == PARALLEL_BREADTH_FIRST;
+            if(options.algorithm == RANKED && result.algorithm != RANKED){
+                std::cerr << "The depths of all the placements of the cars don't fit in "
+                          << options.memoryMegabytes << " MB, used the breadth-first search\n";
+            }
+        }
+    } catch(const std::exception &e){
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    if(!statsFile.empty()){
+        std::ofstream out(statsFile);
+        result.stats.writeJson(out);
+    }
+    if(!traceFile.empty()){
+        std::ofstream out(traceFile);
+        result.stats.writeChromeTrace(out);
+    }
+
+    if(result.found){
+        std::cout << "Found solution !\n";
+        std::cout << "In " << result.depth << " moves\n";
+        std::cout << "Explored " << result.explored << " states\n";
+        if(treeSearch && solver.tree().size()){
+            // The other searches don't keep their states in a SearchTree
+            const SearchTree &tree = solver.tree();
+            std::cout << "Memory per state : " << tree.memoryBytes() / tree.size() << " bytes ("
+                      << tree.memoryBytes() << " bytes for the " << tree.size() << " states of the tree, "
+                      << sizeof(StateKey) + sizeof(int32_t) + sizeof(uint16_t)
+                      << " bytes per node plus the index and the room reserved)\n";
+        }
+        std::cout << "Elapsed seconds : " << result.seconds << "\n";
+        std::cout << "[Presse ENTER to see the steps]\n";
+
+        for(const State &s : result.path){
+            s.applyTo(m);
+            std::cout << m.toString();
+            std::cin.ignore();
+        }
+    } else {
+        std::cout << "No solution found :(\n";
+    }
+    return 0;
+}
@@ -1,15 +1,7 @@
+TEMPLATE        = subdirs
 
-QT              -= gui core
-CONFIG          += c++17
-QMAKE_CXXFLAGS  += -std=c++17
+SUBDIRS         = librushhour cli bench
 
-SOURCES += src/main.cpp \
-            src/Car.cpp \
-            src/Map.cpp \
-            src/State.cpp
-
-HEADERS += \
-           src/Car.hpp \
-           src/Map.hpp \
-           src/Point.hpp \
-           src/State.hpp
+librushhour.file = src/librushhour.pro
+cli.depends     = librushhour
+bench.depends   = librushhour
@@ -0,0 +1,240 @@
+#include "Batch.hpp"
+#include "Map.hpp"
+#include "ThreadPool.hpp"
+#include "Solver.hpp"
+#include "PuzzlePack.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief quoteJson writes a string as a JSON string literal
+ * @param out the stream to write to
+ * @param text the string to write
+ */
+void quoteJson(std::ostream &out, const std::string &text)
+{
+    const char *hex = "0123456789abcdef";
+    out << '"';
+    for(char c : text){
+        if(c == '"' || c == '\\') out << '\\' << c;
+        else if(c == '\n') out << "\\n";
+        else if(c == '\r') out << "\\r";
+        else if(c == '\t') out << "\\t";
+        else if(static_cast<unsigned char>(c) < 0x20) out << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+        else out << c;
+    }
+    out << '"';
+}
+
+/**
+ * @brief quoteCsv writes a string as a CSV field, quoted
+ * when it contains a separator, a quote or a line break
+ * @param out the stream to write to
+ * @param text the string to write
+ */
+void quoteCsv(std::ostream &out, const std::string &text)
+{
+    if(text.find_first_of(",\"\r\n") == std::string::npos){
+        out << text;
+        return;
+    }
+    out << '"';
+    for(char c : text){
+        if(c == '"') out << '"';
+        out << c;
+    }
+    out << '"';
+}
+
+/**
+ * @brief describeMoves turns the states of a solution into readable moves
+ * @param path the states of the solution
+ * @return the moves, as the code of the car followed by the signed distance
+ */
+std::vector<std::string> describeMoves(const std::vector<State> &path)
+{
+    std::vector<std::string> moves;
+    for(size_t i = 1; i < path.size(); ++i){
+        Move move = path[i - 1].moveTo(path[i]);
+        std::string text(1, toReadable(path[i - 1].car(move.car).code));
+        text += move.distance > 0 ? "+" : "";
+        text += std::to_string(move.distance);
+        moves.push_back(text);
+    }
+    return moves;
+}
+
+/**
+ * @brief batchResult the outcome of a puzzle from the result of its search
+ * @param solved the result of the search
+ * @return the outcome of the puzzle, without its file and time
+ */
+BatchResult batchResult(const SolverResult &solved)
+{
+    BatchResult result;
+    result.found = solved.found;
+    result.explored = solved.explored;
+    result.moves = describeMoves(solved.path);
+    return result;
+}
+
+}
+
+BatchResult::BatchResult():
+    file(),
+    found(false),
+    moves(),
+    explored(0),
+    seconds(0),
+    error()
+{
+
+}
+
+std::vector<std::string> listPuzzles(const std::vector<std::string> &paths)
+{
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    for(const std::string &path : paths){
+        std::error_code error;
+        if(!fs::is_directory(path, error)){
+            files.push_back(path);
+            continue;
+        }
+        std::vector<std::string> found;
+        for(const fs::directory_entry &entry : fs::directory_iterator(path, error)){
+            std::string extension = entry.path().extension().string();
+            if(entry.is_regular_file(error) && (extension == ".txt" || extension == ".rhp")){
+                found.push_back(entry.path().string());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return files;
+}
+
+BatchResult solveMap(const Map &map, Solver &solver, const SolverOptions &options)
+{
+    return batchResult(solver.solve(map, options));
+}
+
+BatchResult solvePuzzle(const PuzzlePack &pack, size_t index, Solver &solver, const SolverOptions &options)
+{
+    BatchResult result;
+    auto start = std::chrono::steady_clock::now();
+    try{
+        Map board;
+        State start;
+        pack.puzzle(index, board, start);
+        result = batchResult(solver.solve(board, start, options));
+    } catch(const std::exception &e){
+        result.error = e.what();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    return result;
+}
+
+size_t solveBatch(const std::vector<std::string> &files, int threadCount, const SolverOptions &options,
+                  std::ostream &out, BatchFormat format)
+{
+    // The puzzles to solve, as the index of their pack and their index in the pack
+    std::vector<std::pair<size_t, size_t>> puzzles;
+    std::vector<std::unique_ptr<PuzzlePack>> packs;
+    std::vector<BatchResult> results;
+    for(const std::string &file : files){
+        packs.emplace_back(new PuzzlePack());
+        if(!packs.back()->open(file)){
+            puzzles.emplace_back(packs.size() - 1, 0);
+            results.emplace_back();
+            results.back().file = file;
+            results.back().error = "Can't open the puzzle " + file;
+            continue;
+        }
+        size_t count = packs.back()->size();
+        for(size_t i = 0; i < count; ++i){
+            puzzles.emplace_back(packs.size() - 1, i);
+            results.emplace_back();
+            results.back().file = count == 1 ? file : file + "#" + std::to_string(i + 1);
+        }
+    }
+
+    writeHeader(out, format);
+
+    // The outcomes are written in order by the worker completing the first
+    // one not written yet, then freed
+    std::mutex writing;
+    std::vector<char> done(puzzles.size(), 0);
+    size_t written = 0;
+    size_t failed = 0;
+    ThreadPool pool(std::max(1, std::min<int>(threadCount, static_cast<int>(puzzles.size()))));
+    std::vector<Solver> solvers(pool.size());
+    pool.run(puzzles.size(), [&](size_t index, int worker){
+        if(results[index].error.empty()){
+            const PuzzlePack &pack = *packs[puzzles[index].first];
+            std::string file = results[index].file;
+            results[index] = solvePuzzle(pack, puzzles[index].second, solvers[worker], options);
+            results[index].file = file;
+        }
+
+        std::lock_guard<std::mutex> lock(writing);
+        done[index] = 1;
+        while(written < puzzles.size() && done[written]){
+            writeResult(out, results[written], format);
+            if(!results[written].error.empty()) failed++;
+            results[written] = BatchResult();
+            written++;
+        }
+        out.flush();
+    });
+    return failed;
+}
+
+void writeResult(std::ostream &out, const BatchResult &result, BatchFormat format)
+{
+    int moveCount = result.found ? static_cast<int>(result.moves.size()) : -1;
+    if(format == CSV){
+        std::string solution;
+        for(const std::string &move : result.moves){
+            if(!solution.empty()) solution += ' ';
+            solution += move;
+        }
+        quoteCsv(out, result.file);
+        out << ',' << (result.found ? "true" : "false") << ',' << moveCount << ','
+            << result.explored << ',' << result.seconds << ',' << solution << ',';
+        quoteCsv(out, result.error);
+        out << '\n';
+    } else {
+        out << '{';
+        if(!result.file.empty()){
+            out << "\"file\":";
+            quoteJson(out, result.file);
+            out << ',';
+        }
+        out << "\"solved\":" << (result.found ? "true" : "false") << ",\"moves\":" << moveCount
+            << ",\"explored\":" << result.explored << ",\"seconds\":" << result.seconds
+            << ",\"solution\":[";
+        for(size_t i = 0; i < result.moves.size(); ++i){
+            out << (i ? "," : "") << '"' << result.moves[i] << '"';
+        }
+        out << ']';
+        if(!result.error.empty()){
+            out << ",\"error\":";
+            quoteJson(out, result.error);
+        }
+        out << "}\n";
+    }
+}
+
+void writeHeader(std::ostream &out, BatchFormat format)
+{
+    if(format == CSV) out << "file,solved,moves,explored,seconds,solution,error\n";
+}
@@ -0,0 +1,136 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+class Map;
+class Solver;
+struct SolverOptions;
+class PuzzlePack;
+
+/**
+ * @brief The BatchResult struct the outcome of a puzzle of a batch
+ */
+struct BatchResult{
+
+    /**
+     * @brief BatchResult constructor, for a puzzle not solved yet
+     */
+    BatchResult();
+
+    /**
+     * @brief file the path of the puzzle
+     */
+    std::string file;
+
+    /**
+     * @brief found wether a solution was found
+     */
+    bool found;
+
+    /**
+     * @brief moves the moves of the solution, as the code of the car
+     * followed by the signed distance (positive to move right or down), e.g. "b+2"
+     */
+    std::vector<std::string> moves;
+
+    /**
+     * @brief explored number of states expanded by the search
+     */
+    size_t explored;
+
+    /**
+     * @brief seconds time spent reading and solving the puzzle
+     */
+    double seconds;
+
+    /**
+     * @brief error why the puzzle couldn't be solved, empty if it was searched
+     */
+    std::string error;
+};
+
+/**
+ * @brief The BatchFormat enum how the results of a batch are written
+ */
+enum BatchFormat{
+    /**
+     * @brief JSON_LINES one JSON object per puzzle and per line
+     */
+    JSON_LINES,
+
+    /**
+     * @brief CSV a header line, then one line per puzzle
+     */
+    CSV
+};
+
+/**
+ * @brief listPuzzles gathers the puzzles to solve : the files are taken
+ * as they are, the directories give all the puzzle files (.txt) and
+ * binary packs (.rhp) they contain, by name
+ * @param paths the files and directories given
+ * @return the path of every puzzle
+ */
+std::vector<std::string> listPuzzles(const std::vector<std::string> &paths);
+
+/**
+ * @brief solveMap finds the shortest solution of a map, throws an
+ * exception if the cars of the map can't be handled
+ * @param map the map read, with its cars
+ * @param solver the solver to use, its memory is reused
+ * @param options how to solve it
+ * @return the outcome of the puzzle, without its file and time
+ */
+BatchResult solveMap(const Map &map, Solver &solver, const SolverOptions &options);
+
+/**
+ * @brief solvePuzzle reads a puzzle of a pack and finds its shortest
+ * solution, the errors are reported in the result instead of thrown
+ * @param pack the pack of the puzzle
+ * @param index the index of the puzzle in the pack
+ * @param solver the solver to use, its memory is reused
+ * @param options how to solve it
+ * @return the outcome of the puzzle, without its file
+ */
+BatchResult solvePuzzle(const PuzzlePack &pack, size_t index, Solver &solver, const SolverOptions &options);
+
+/**
+ * @brief solveBatch solves all the puzzles on a thread pool, each
+ * puzzle being read and solved by a single worker, on its own map,
+ * every worker reuses the same Solver for all its puzzles.
+ * Every file is read as a PuzzlePack, the puzzles of a pack with several
+ * puzzles are named by the file followed by their number, e.g. "pack.rhp#3".
+ * The outcome of a puzzle is written, in the order of the files, as soon as
+ * it and all the puzzles before it are solved, so the whole batch is never held
+ * @param files the path of every puzzle file or pack
+ * @param threadCount number of puzzles solved at the same time
+ * @param options how to solve every puzzle
+ * @param out the stream the outcomes are written to, checked by the caller
+ * @param format the format of the output
+ * @return the number of puzzles that couldn't be read or solved
+ */
+size_t solveBatch(const std::vector<std::string> &files, int threadCount, const SolverOptions &options,
+                  std::ostream &out, BatchFormat format);
+
+/**
+ * @brief writeResult writes the outcome of a puzzle, the file is
+ * left out of the JSON object when it is empty
+ * @param out the stream to write to
+ * @param result the outcome of the puzzle
+ * @param format the format of the output
+ */
+void writeResult(std::ostream &out, const BatchResult &result, BatchFormat format);
+
+/**
+ * @brief writeHeader writes what comes before the outcomes of the puzzles,
+ * the names of the columns for CSV, nothing for JSON lines
+ * @param out the stream to write to
+ * @param format the format of the output
+ */
+void writeHeader(std::ostream &out, BatchFormat format);
+
+#endif // BATCH_HPP
@@ -0,0 +1,71 @@
+#include "Bitboard.hpp"
+
+CarTrack::CarTrack():
+    rows(),
+    columns(),
+    behind(),
+    ahead(),
+    lineStart(0),
+    length(0),
+    lastOrigin(0),
+    vertical(false)
+{
+
+}
+
+CarTrack::CarTrack(const MapCar &data, int width, int height):
+    CarTrack()
+{
+    vertical = data.orientation == Orientation::VERTICAL;
+    int lineLength = vertical ? height : width;
+    int crossLength = vertical ? width : height;
+    lineStart = data.axisValue * lineLength;
+    length = data.length;
+    lastOrigin = lineLength - 1 - data.length;
+
+    BitMask carBits = (BitMask(1) << data.length) - 1;
+    for(int origin = 1; origin <= lastOrigin; ++origin){
+        // Along the track the car is contiguous, across it the
+        // cells are one line apart
+        BitMask along = carBits << (lineStart + origin);
+        BitMask across = 0;
+        for(int i = origin; i < origin + data.length; ++i){
+            across |= BitMask(1) << (i * crossLength + data.axisValue);
+        }
+        rows[origin] = vertical ? across : along;
+        columns[origin] = vertical ? along : across;
+
+        int end = origin + data.length;
+        behind[origin] = ((BitMask(1) << (origin - 1)) - 1) << (lineStart + 1);
+        ahead[origin] = ((BitMask(1) << (lineLength - 1 - end)) - 1) << (lineStart + end);
+    }
+}
+
+Bitboard::Bitboard():
+    m_rows(0),
+    m_columns(0),
+    m_width(0),
+    m_height(0)
+{
+
+}
+
+Bitboard::Bitboard(int width, int height):
+    m_rows(0),
+    m_columns(0),
+    m_width(width),
+    m_height(height)
+{
+
+}
+
+void Bitboard::setOccupied(int x, int y)
+{
+    m_rows |= BitMask(1) << (y * m_width + x);
+    m_columns |= BitMask(1) << (x * m_height + y);
+}
+
+bool Bitboard::isOccupied(int x, int y) const
+{
+    return (m_rows >> (y * m_width + x)) & 1;
+}
@@ -0,0 +1,279 @@
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+#include <cstdint>
+#include "Car.hpp"
+
+/**
+ * @brief BitMask one bit per cell of the map, 128 bits
+ * are enough to store a 10x10 map (including borders)
+ */
+typedef unsigned __int128 BitMask;
+
+/**
+ * @brief lowestBit index of the least significant bit set
+ * in the given mask, the mask must not be empty
+ * @param mask the mask to scan
+ * @return the index of the lowest bit set
+ */
+inline int lowestBit(BitMask mask)
+{
+    uint64_t low = static_cast<uint64_t>(mask);
+    if(low) return __builtin_ctzll(low);
+    return 64 + __builtin_ctzll(static_cast<uint64_t>(mask >> 64));
+}
+
+/**
+ * @brief lowestBit index of the least significant bit set
+ * in the given 64 bits mask, the mask must not be empty
+ * @param mask the mask to scan
+ * @return the index of the lowest bit set
+ */
+inline int lowestBit(uint64_t mask)
+{
+    return __builtin_ctzll(mask);
+}
+
+/**
+ * @brief highestBit index of the most significant bit set
+ * in the given mask, the mask must not be empty
+ * @param mask the mask to scan
+ * @return the index of the highest bit set
+ */
+inline int highestBit(BitMask mask)
+{
+    uint64_t high = static_cast<uint64_t>(mask >> 64);
+    if(high) return 127 - __builtin_clzll(high);
+    return 63 - __builtin_clzll(static_cast<uint64_t>(mask));
+}
+
+/**
+ * @brief highestBit index of the most significant bit set
+ * in the given 64 bits mask, the mask must not be empty
+ * @param mask the mask to scan
+ * @return the index of the highest bit set
+ */
+inline int highestBit(uint64_t mask)
+{
+    return 63 - __builtin_clzll(mask);
+}
+
+/**
+ * @brief MAX_LINE maximum number of cells of a row or a column
+ * (including borders), the size of the per-origin tables of a car
+ */
+const int MAX_LINE = 16;
+
+/**
+ * @brief The CarTrack struct everything about the moves of a car
+ * that only depends on its position, computed once when the car is
+ * found on the map : for every origin the car can take, the bits it
+ * covers and the bits of its track in front of and behind it.
+ * With these tables, painting a car or finding how far it can slide
+ * is a few table lookups and a bit scan
+ */
+struct CarTrack{
+
+    /**
+     * @brief CarTrack empty constructor, for the tables of the map
+     */
+    CarTrack();
+
+    /**
+     * @brief CarTrack constructor, computes the tables of the car
+     * @param data the metadata of the car
+     * @param width width of the map (including borders)
+     * @param height height of the map (including borders)
+     */
+    CarTrack(const MapCar &data, int width, int height);
+
+    /**
+     * @brief rows the row-major bits of the car, for every origin
+     */
+    BitMask rows[MAX_LINE];
+
+    /**
+     * @brief columns the column-major bits of the car, for every origin
+     */
+    BitMask columns[MAX_LINE];
+
+    /**
+     * @brief behind the cells of the track between the border
+     * and the origin of the car (excluded), for every origin, in
+     * the mask where the track is contiguous
+     */
+    BitMask behind[MAX_LINE];
+
+    /**
+     * @brief ahead the cells of the track between the end of
+     * the car (excluded) and the border, for every origin, in
+     * the mask where the track is contiguous
+     */
+    BitMask ahead[MAX_LINE];
+
+    /**
+     * @brief lineStart index of the first bit of the track
+     * (the border cell) in the mask where the track is contiguous
+     */
+    int8 lineStart;
+
+    /**
+     * @brief length the length of the car
+     */
+    int8 length;
+
+    /**
+     * @brief lastOrigin the largest origin of the car
+     * before it touches the border, the smallest is always 1
+     */
+    int8 lastOrigin;
+
+    /**
+     * @brief vertical wether the track is a column
+     */
+    bool vertical;
+};
+
+/**
+ * @brief The Bitboard class occupancy of the map stored
+ * as bit masks, every non-empty cell (wall, exit or car)
+ * has its bit set.
+ * The occupancy is stored twice : once row by row, used by
+ * the horizontal cars, and once column by column, used by the
+ * vertical cars. This way, the cells in front of and behind
+ * any car are always contiguous bits, and the distance a car
+ * can slide is found with a single bit scan
+ */
+class Bitboard
+{
+public:
+    /**
+     * @brief Bitboard empty constructor
+     */
+    Bitboard();
+
+    /**
+     * @brief Bitboard constructor for an empty board
+     * @param width width of the map (including borders)
+     * @param height height of the map (including borders)
+     */
+    Bitboard(int width, int height);
+
+    /**
+     * @brief setOccupied marks the given cell as non-empty
+     * @param x the x coordinate
+     * @param y the y coordinate
+     */
+    void setOccupied(int x, int y);
+
+    /**
+     * @brief isOccupied wether the given cell is non-empty
+     * @param x the x coordinate
+     * @param y the y coordinate
+     * @return wether there is something on the given cell
+     */
+    bool isOccupied(int x, int y) const;
+
+    /**
+     * @brief addCar marks all the cells of the car as occupied
+     * @param track the tables of the car
+     * @param origin the position of the car
+     */
+    void addCar(const CarTrack &track, int origin)
+    {
+        m_rows |= track.rows[origin];
+        m_columns |= track.columns[origin];
+    }
+
+    /**
+     * @brief removeCar marks all the cells of the car as empty
+     * @param track the tables of the car
+     * @param origin the position of the car
+     */
+    void removeCar(const CarTrack &track, int origin)
+    {
+        m_rows &= ~track.rows[origin];
+        m_columns &= ~track.columns[origin];
+    }
+
+    /**
+     * @brief freeBefore number of empty cells between the origin
+     * of the car and the first obstacle on its way (left or up)
+     * @param track the tables of the car
+     * @param origin the position of the car
+     * @return the maximum distance the car can move backward
+     */
+    int freeBefore(const CarTrack &track, int origin) const
+    {
+        BitMask blocked = lines(track) & track.behind[origin];
+        if(!blocked) return origin - 1;
+        return track.lineStart + origin - highestBit(blocked) - 1;
+    }
+
+    /**
+     * @brief freeAfter number of empty cells between the end
+     * of the car and the first obstacle on its way (right or down)
+     * @param track the tables of the car
+     * @param origin the position of the car
+     * @return the maximum distance the car can move forward
+     */
+    int freeAfter(const CarTrack &track, int origin) const
+    {
+        BitMask blocked = lines(track) & track.ahead[origin];
+        if(!blocked) return track.lastOrigin - origin;
+        return lowestBit(blocked) - (track.lineStart + origin + track.length);
+    }
+
+    /**
+     * @brief rows accessor for the occupancy, bit y * width + x
+     * @return the row-major mask
+     */
+    const BitMask &rows() const
+    {
+        return m_rows;
+    }
+
+    /**
+     * @brief columns accessor for the occupancy, bit x * height + y
+     * @return the column-major mask
+     */
+    const BitMask &columns() const
+    {
+        return m_columns;
+    }
+
+private:
+    /**
+     * @brief lines the mask the car moves on : the row-major
+     * mask for horizontal cars, the column-major mask for
+     * vertical cars
+     * @param track the tables of the car
+     * @return the mask where the car's track is contiguous
+     */
+    const BitMask &lines(const CarTrack &track) const
+    {
+        return track.vertical ? m_columns : m_rows;
+    }
+
+    /**
+     * @brief m_rows the occupancy, bit y * width + x
+     */
+    BitMask m_rows;
+
+    /**
+     * @brief m_columns the occupancy, bit x * height + y
+     */
+    BitMask m_columns;
+
+    /**
+     * @brief m_width the map's width
+     */
+    int m_width;
+
+    /**
+     * @brief m_height the map's height
+     */
+    int m_height;
+};
+
+#endif // BITBOARD_HPP
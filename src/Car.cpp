@@ -1,15 +1,17 @@
 #include "Car.hpp"
 
-StateCar::StateCar(int8 carCode, int8 carOrigin):
-    code(carCode),
-    origin(carOrigin)
+StateCar::StateCar():
+    code(0),
+    origin(0)
 {
 
 }
 
-int8 StateCar::toInt7() const
+StateCar::StateCar(int8 carCode, int8 carOrigin):
+    code(carCode),
+    origin(carOrigin)
 {
-    return ((code & 0x0f) << 4) | ((origin-1) & 0x07);
+
 }
 
 MapCar::MapCar(int8 carCode, int8 carLength, Orientation carOrientation, int8 carAxis):
@@ -12,6 +12,12 @@ enum Orientation {
     HORIZONTAL
 };
 
+/**
+ * @brief MAX_CARS maximum number of cars on a map (including
+ * the main car), the codes go from 'a' to 'y' ('x' being a wall)
+ */
+const int MAX_CARS = 25;
+
 /**
  * @brief The StateCar struct
  * The state car must be as small as possible to be replicated as much
@@ -19,12 +25,17 @@ enum Orientation {
  * car's code (its id) and its origin.
  * The origin is the left-most part when the car is horizontal, and
  * the top-most part when the car is vertical
- * It can be encoded on 7 bits, assuming the map has no more than 16 cars
- * and the map cannot be bigger than 10x10 (including borders)
- * The StateCar struct is stored for every cars on every State
+ * The StateCar struct is stored for every cars on every State, the
+ * packed states only keep the origin (see StateEncoder)
  */
 struct StateCar{
 
+    /**
+     * @brief StateCar empty constructor, for the fixed-size
+     * storage of the states
+     */
+    StateCar();
+
     /**
      * @brief StateCar constructor
      * @param code the car's id, must be unique and not used by other cars
@@ -32,14 +43,6 @@ struct StateCar{
      */
     StateCar(int8 code, int8 origin);
 
-    /**
-     * @brief toInt7 encodes this StateCar on a 7 bits int
-     * The 4 bigger bits encode the car's code (thus cannot be bigger than 15)
-     * and the 3 smaller bits encode the car's origin (thus cannot be bigger than 7)
-     * @return the encoded car
-     */
-    int8 toInt7() const;
-
     /**
      * @brief code the car's unique id,
      * used to retrieve the metadata stored in the map
@@ -58,7 +61,7 @@ struct StateCar{
 struct MapCar{
 
     /**
-     * @brief MapCar empty constructor for the std::unordered_map
+     * @brief MapCar empty constructor, for the tables of the map
      */
     MapCar();
 
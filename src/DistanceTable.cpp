@@ -0,0 +1,149 @@
+#include "DistanceTable.hpp"
+#include "Map.hpp"
+#include "StateMap.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+DistanceTable::DistanceTable():
+    m_encoder(),
+    m_keys(),
+    m_distances(),
+    m_goalCount(0),
+    m_maxDistance(-1)
+{
+
+}
+
+DistanceTable::DistanceTable(Map &map, const State &start):
+    DistanceTable()
+{
+    m_encoder = map.encoder();
+
+    // Enumerate the cluster, keeping the neighbours of every state
+    // (edges[firstEdge[i]] to edges[firstEdge[i + 1]]) for the backward search
+    std::vector<State> states(1, start);
+    StateMap<uint32_t> indexes;
+    indexes.insert(start.key(m_encoder), 0);
+    std::vector<State> successors;
+    std::vector<uint32_t> edges;
+    std::vector<size_t> firstEdge(1, 0);
+    for(size_t i = 0; i < states.size(); ++i){
+        successors.clear();
+        states[i].successors(map, successors);
+        for(const State &next : successors){
+            auto inserted = indexes.insert(next.key(m_encoder), static_cast<uint32_t>(states.size()));
+            if(inserted.second) states.push_back(next);
+            edges.push_back(*inserted.first);
+        }
+        firstEdge.push_back(edges.size());
+    }
+
+    // Backward search, from all the solved states at once
+    std::vector<uint8_t> distances(states.size(), NO_SOLUTION);
+    std::vector<uint32_t> layer;
+    for(size_t i = 0; i < states.size(); ++i){
+        if(states[i].isSolutionOf(map)){
+            distances[i] = 0;
+            layer.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    m_goalCount = layer.size();
+
+    std::vector<uint32_t> nextLayer;
+    int depth = 0;
+    while(!layer.empty()){
+        m_maxDistance = depth;
+        if(depth + 1 >= NO_SOLUTION) throw std::runtime_error("The cluster is too deep to be stored in the table");
+        nextLayer.clear();
+        for(uint32_t index : layer){
+            for(size_t e = firstEdge[index]; e < firstEdge[index + 1]; ++e){
+                uint32_t nextIndex = edges[e];
+                if(distances[nextIndex] == NO_SOLUTION){
+                    distances[nextIndex] = static_cast<uint8_t>(depth + 1);
+                    nextLayer.push_back(nextIndex);
+                }
+            }
+        }
+        layer.swap(nextLayer);
+        depth++;
+    }
+
+    // Keep only the sorted keys and their distance
+    std::vector<StateKey> keys(states.size());
+    for(size_t i = 0; i < states.size(); ++i) keys[i] = states[i].key(m_encoder);
+    std::vector<uint32_t> order(states.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){ return keys[a] < keys[b]; });
+    m_keys.resize(order.size());
+    m_distances.resize(order.size());
+    for(size_t i = 0; i < order.size(); ++i){
+        m_keys[i] = keys[order[i]];
+        m_distances[i] = distances[order[i]];
+    }
+}
+
+int DistanceTable::distance(const State &state) const
+{
+    StateKey key = state.key(m_encoder);
+    auto found = std::lower_bound(m_keys.begin(), m_keys.end(), key);
+    if(found == m_keys.end() || *found != key) return -1;
+    uint8_t value = m_distances[found - m_keys.begin()];
+    return value == NO_SOLUTION ? -1 : value;
+}
+
+bool DistanceTable::bestMove(Map &map, const State &state, Move &move) const
+{
+    int current = distance(state);
+    if(current <= 0) return false;
+    std::vector<Move> moves;
+    state.moves(map, moves);
+    for(const Move &candidate : moves){
+        State next = state;
+        next.play(candidate);
+        if(distance(next) == current - 1){
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<State> DistanceTable::solution(Map &map, const State &state) const
+{
+    std::vector<State> path;
+    if(distance(state) < 0) return path;
+    path.push_back(state);
+    Move move;
+    while(bestMove(map, path.back(), move)){
+        path.push_back(path.back());
+        path.back().play(move);
+    }
+    return path;
+}
+
+size_t DistanceTable::size() const
+{
+    return m_keys.size();
+}
+
+size_t DistanceTable::goalCount() const
+{
+    return m_goalCount;
+}
+
+int DistanceTable::maxDistance() const
+{
+    return m_maxDistance;
+}
+
+const std::vector<StateKey> &DistanceTable::keys() const
+{
+    return m_keys;
+}
+
+const std::vector<uint8_t> &DistanceTable::distances() const
+{
+    return m_distances;
+}
@@ -0,0 +1,128 @@
+#ifndef DISTANCETABLE_HPP
+#define DISTANCETABLE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "State.hpp"
+
+class Map;
+
+/**
+ * @brief The DistanceTable class the exact number of moves
+ * needed to solve every state reachable from a starting state
+ * (its cluster).
+ * The whole cluster is enumerated first, with the neighbours of
+ * every state, then a breadth-first search goes backward from all
+ * the solved states at once, along the same links (the moves can
+ * always be reverted, so the backward moves are the same as the
+ * forward ones). The table keeps only the sorted
+ * packed states and their distance, so any state of the cluster
+ * is answered with a single binary search
+ */
+class DistanceTable
+{
+public:
+    /**
+     * @brief NO_SOLUTION distance stored for the states
+     * that can't reach any solved state
+     */
+    static constexpr uint8_t NO_SOLUTION = 0xff;
+
+    /**
+     * @brief DistanceTable empty constructor, for an empty table
+     */
+    DistanceTable();
+
+    /**
+     * @brief DistanceTable builds the table of the cluster of the given state
+     * throws an exception if a distance does not fit in the table
+     * @param map the map of the state, used as the working board
+     * @param start any state of the cluster
+     */
+    DistanceTable(Map &map, const State &start);
+
+    /**
+     * @brief distance the number of moves needed to solve the given state
+     * @param state the state to look for
+     * @return the number of moves, -1 if the state is not in the cluster,
+     * or has no solution
+     */
+    int distance(const State &state) const;
+
+    /**
+     * @brief bestMove finds a move leading one step closer to the solution
+     * @param map the map of the state, used as the working board
+     * @param state the state to play from
+     * @param move the best move found
+     * @return false if the state is solved, not in the cluster or has no solution
+     */
+    bool bestMove(Map &map, const State &state, Move &move) const;
+
+    /**
+     * @brief solution follows the best moves from the given state
+     * @param map the map of the state, used as the working board
+     * @param state the state to solve
+     * @return all the states from the given one to the solution,
+     * empty if the state has no solution
+     */
+    std::vector<State> solution(Map &map, const State &state) const;
+
+    /**
+     * @brief size number of states of the cluster
+     * @return the number of states of the cluster
+     */
+    size_t size() const;
+
+    /**
+     * @brief goalCount number of solved states in the cluster
+     * @return the number of solved states
+     */
+    size_t goalCount() const;
+
+    /**
+     * @brief maxDistance number of moves of the hardest state of the cluster
+     * @return the highest distance of the table, -1 if no state can be solved
+     */
+    int maxDistance() const;
+
+    /**
+     * @brief keys all the states of the cluster, sorted
+     * @return the packed states
+     */
+    const std::vector<StateKey> &keys() const;
+
+    /**
+     * @brief distances the distance of each state, in the order of 'keys'
+     * @return the distances, NO_SOLUTION for the states without solution
+     */
+    const std::vector<uint8_t> &distances() const;
+
+private:
+    /**
+     * @brief m_encoder the layout of the packed states of the map
+     */
+    StateEncoder m_encoder;
+
+    /**
+     * @brief m_keys the packed states of the cluster, sorted
+     */
+    std::vector<StateKey> m_keys;
+
+    /**
+     * @brief m_distances the distance of each state of m_keys
+     */
+    std::vector<uint8_t> m_distances;
+
+    /**
+     * @brief m_goalCount number of solved states
+     */
+    size_t m_goalCount;
+
+    /**
+     * @brief m_maxDistance highest distance of the table
+     */
+    int m_maxDistance;
+};
+
+#endif // DISTANCETABLE_HPP
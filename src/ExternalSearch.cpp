@@ -0,0 +1,416 @@
+#include "ExternalSearch.hpp"
+#include "Map.hpp"
+#include "SearchStats.hpp"
+
+#include <fstream>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief MIN_READ_BUFFER smallest number of keys read at once from a file
+ */
+const size_t MIN_READ_BUFFER = 4096;
+
+/**
+ * @brief EXPANSION_READERS share of the memory given to the reader
+ * of the layer being expanded, next to the buffer of successors
+ */
+const int EXPANSION_READERS = 16;
+
+/**
+ * @brief searchCount numbers the searches of the process, so that the
+ * searches running at the same time in a folder use different files
+ */
+std::atomic<unsigned> searchCount(0);
+
+/**
+ * @brief The KeyReader class reads a file of keys sequentially, one buffer at a time
+ */
+class KeyReader
+{
+public:
+    /**
+     * @brief KeyReader constructor, reads the first key
+     * @param path the file to read
+     * @param bufferKeys number of keys read at once
+     */
+    KeyReader(const std::string &path, size_t bufferKeys):
+        m_file(path, std::ios::binary),
+        m_buffer(bufferKeys),
+        m_position(0),
+        m_count(0)
+    {
+        if(!m_file.is_open()) throw std::runtime_error("Can't read " + path);
+        fill();
+    }
+
+    /**
+     * @brief done wether all the keys were read
+     * @return wether there is no current key
+     */
+    bool done() const
+    {
+        return m_position == m_count;
+    }
+
+    /**
+     * @brief current the key under the cursor, the reader must not be done
+     * @return the current key
+     */
+    StateKey current() const
+    {
+        return m_buffer[m_position];
+    }
+
+    /**
+     * @brief next moves to the next key
+     */
+    void next()
+    {
+        if(++m_position == m_count) fill();
+    }
+
+private:
+    /**
+     * @brief fill reads the next buffer of keys
+     */
+    void fill()
+    {
+        m_file.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size() * sizeof(StateKey));
+        m_count = m_file.gcount() / sizeof(StateKey);
+        m_position = 0;
+    }
+
+    std::ifstream m_file;
+    std::vector<StateKey> m_buffer;
+    size_t m_position;
+    size_t m_count;
+};
+
+/**
+ * @brief The KeyWriter class writes keys to a file, one buffer at a time
+ */
+class KeyWriter
+{
+public:
+    /**
+     * @brief KeyWriter constructor, creates (or truncates) the file
+     * @param path the file to write
+     * @param bufferKeys number of keys written at once
+     */
+    KeyWriter(const std::string &path, size_t bufferKeys):
+        m_file(path, std::ios::binary | std::ios::trunc),
+        m_buffer(),
+        m_count(0)
+    {
+        if(!m_file.is_open()) throw std::runtime_error("Can't write " + path);
+        m_buffer.reserve(bufferKeys);
+    }
+
+    /**
+     * @brief push appends a key to the file
+     * @param key the key to write
+     */
+    void push(StateKey key)
+    {
+        m_buffer.push_back(key);
+        m_count++;
+        if(m_buffer.size() == m_buffer.capacity()) flush();
+    }
+
+    /**
+     * @brief flush writes the keys still in the buffer
+     */
+    void flush()
+    {
+        m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size() * sizeof(StateKey));
+        if(!m_file) throw std::runtime_error("Can't write the keys, the disk may be full");
+        m_buffer.clear();
+    }
+
+    /**
+     * @brief count number of keys written
+     * @return the number of keys pushed
+     */
+    size_t count() const
+    {
+        return m_count;
+    }
+
+private:
+    std::ofstream m_file;
+    std::vector<StateKey> m_buffer;
+    size_t m_count;
+};
+
+/**
+ * @brief The LayeredSearch class the files of an external search :
+ * one sorted file per layer, and the runs of the layer being built
+ */
+class LayeredSearch
+{
+public:
+    /**
+     * @brief LayeredSearch constructor
+     * @param map the map to solve, used as the working board
+     * @param start the starting state
+     * @param directory the folder of the files
+     * @param memoryMegabytes the size of the buffer of successors
+     */
+    LayeredSearch(Map &map, const State &start, const std::string &directory, size_t memoryMegabytes):
+        m_map(map),
+        m_start(start),
+        m_prefix(directory + "/rushhour-" + std::to_string(getpid()) + "-" + std::to_string(searchCount++) + "-"),
+        m_buffer(),
+        m_bufferKeys(std::max<size_t>(1, memoryMegabytes) * 1024 * 1024 / sizeof(StateKey)),
+        m_runCount(0),
+        m_layerCount(0)
+    {
+    }
+
+    ~LayeredSearch()
+    {
+        for(int i = 0; i < m_runCount; ++i) std::remove(runPath(i).c_str());
+        for(int i = 0; i < m_layerCount; ++i) std::remove(layerPath(i).c_str());
+    }
+
+    /**
+     * @brief run explores the layers until a solution is found
+     * @return the result of the search
+     */
+    SearchResult run()
+    {
+        SearchResult result;
+        SearchStats *stats = SearchStats::current();
+        const StateEncoder &encoder = m_map.encoder();
+        {
+            KeyWriter first(layerPath(m_layerCount++), 1);
+            first.push(m_start.key(encoder));
+            first.flush();
+        }
+        size_t layerSize = 1;
+        std::vector<Move> moves;
+
+        for(int depth = 0; layerSize; ++depth){
+            if(stats) stats->beginLayer(depth, layerSize);
+            size_t generated = 0;
+            m_buffer.reserve(m_bufferKeys);
+            KeyReader layer(layerPath(depth), readBuffer(EXPANSION_READERS));
+            for(; !layer.done(); layer.next()){
+                State current = State::fromKey(layer.current(), encoder);
+                if(current.isSolutionOf(m_map)){
+                    result.found = true;
+                    result.path = tracePath(current, depth);
+                    if(stats) stats->endLayer(0, 0, memoryBytes());
+                    return result;
+                }
+                result.explored++;
+                moves.clear();
+                current.moves(m_map, moves);
+                generated += moves.size();
+                for(const Move &move : moves){
+                    State next = current;
+                    next.play(move);
+                    m_buffer.push_back(next.key(encoder));
+                    if(m_buffer.size() == m_bufferKeys) writeRun();
+                }
+            }
+            if(!m_buffer.empty()) writeRun();
+            RUSHHOUR_STATS_GENERATED(generated);
+            // The buffers of the merge take the memory of the successors
+            std::vector<StateKey>().swap(m_buffer);
+
+            size_t expanded = layerSize;
+            layerSize = mergeRuns(depth);
+            if(stats) stats->endLayer(expanded, layerSize, memoryBytes());
+        }
+        return result;
+    }
+
+private:
+    /**
+     * @brief layerPath the file of a layer
+     * @param depth the depth of the layer
+     * @return the path of the file
+     */
+    std::string layerPath(int depth) const
+    {
+        return m_prefix + "layer" + std::to_string(depth) + ".keys";
+    }
+
+    /**
+     * @brief runPath the file of a run
+     * @param run the index of the run in the current layer
+     * @return the path of the file
+     */
+    std::string runPath(int run) const
+    {
+        return m_prefix + "run" + std::to_string(run) + ".keys";
+    }
+
+    /**
+     * @brief readBuffer number of keys each reader can buffer, so
+     * that all the files open at the same time share the memory given
+     * @param files number of files open at the same time
+     * @return the number of keys of a file's buffer
+     */
+    size_t readBuffer(int files) const
+    {
+        return std::max(MIN_READ_BUFFER, m_bufferKeys / files);
+    }
+
+    /**
+     * @brief memoryBytes memory used by the buffers
+     * @return the number of bytes
+     */
+    size_t memoryBytes() const
+    {
+        return m_bufferKeys * sizeof(StateKey);
+    }
+
+    /**
+     * @brief writeRun sorts the buffer, and writes its distinct keys in a new run
+     */
+    void writeRun()
+    {
+        std::sort(m_buffer.begin(), m_buffer.end());
+        m_buffer.erase(std::unique(m_buffer.begin(), m_buffer.end()), m_buffer.end());
+        std::ofstream run(runPath(m_runCount++), std::ios::binary | std::ios::trunc);
+        run.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size() * sizeof(StateKey));
+        if(!run) throw std::runtime_error("Can't write the run, the disk may be full");
+        m_buffer.clear();
+    }
+
+    /**
+     * @brief mergeRuns merges the runs of the successors of a layer into
+     * the next layer, without duplicates, and without the states of the
+     * layer and of the one before it. The runs are removed afterward
+     * @param depth the depth of the expanded layer
+     * @return the number of states of the next layer
+     */
+    size_t mergeRuns(int depth)
+    {
+        // The runs, the two previous layers and the next one
+        int readerCount = m_runCount + (depth > 0 ? 2 : 1) + 1;
+        std::vector<std::unique_ptr<KeyReader>> runs;
+        for(int i = 0; i < m_runCount; ++i){
+            runs.emplace_back(new KeyReader(runPath(i), readBuffer(readerCount)));
+        }
+        std::vector<std::unique_ptr<KeyReader>> previous;
+        for(int d = std::max(0, depth - 1); d <= depth; ++d){
+            previous.emplace_back(new KeyReader(layerPath(d), readBuffer(readerCount)));
+        }
+        KeyWriter next(layerPath(m_layerCount++), readBuffer(readerCount));
+
+        auto greater = [&](int a, int b){ return runs[a]->current() > runs[b]->current(); };
+        std::priority_queue<int, std::vector<int>, decltype(greater)> heads(greater);
+        for(int i = 0; i < m_runCount; ++i){
+            if(!runs[i]->done()) heads.push(i);
+        }
+
+        bool hasLast = false;
+        StateKey last = 0;
+        while(!heads.empty()){
+            int smallest = heads.top();
+            heads.pop();
+            StateKey key = runs[smallest]->current();
+            runs[smallest]->next();
+            if(!runs[smallest]->done()) heads.push(smallest);
+            if(hasLast && key == last) continue;
+            hasLast = true;
+            last = key;
+
+            bool known = false;
+            for(auto &layer : previous){
+                while(!layer->done() && layer->current() < key) layer->next();
+                known = known || (!layer->done() && layer->current() == key);
+            }
+            if(!known) next.push(key);
+        }
+        next.flush();
+
+        runs.clear();
+        for(int i = 0; i < m_runCount; ++i) std::remove(runPath(i).c_str());
+        m_runCount = 0;
+        return next.count();
+    }
+
+    /**
+     * @brief layerContains looks for a key in a layer file, by binary search
+     * @param depth the depth of the layer
+     * @param key the key to look for
+     * @return wether the layer has this state
+     */
+    bool layerContains(int depth, StateKey key) const
+    {
+        int file = open(layerPath(depth).c_str(), O_RDONLY);
+        if(file < 0) throw std::runtime_error("Can't read " + layerPath(depth));
+        off_t low = 0;
+        off_t high = lseek(file, 0, SEEK_END) / sizeof(StateKey);
+        bool found = false;
+        while(low < high && !found){
+            off_t middle = (low + high) / 2;
+            StateKey value = 0;
+            if(pread(file, &value, sizeof(value), middle * sizeof(StateKey)) != sizeof(value)) break;
+            if(value == key) found = true;
+            else if(value < key) low = middle + 1;
+            else high = middle;
+        }
+        close(file);
+        return found;
+    }
+
+    /**
+     * @brief tracePath rebuilds the solution : every state of a layer
+     * has a neighbour in the layer before it, found among its successors
+     * @param last the solved state
+     * @param depth the depth of the solved state
+     * @return the states of the path, the starting state first
+     */
+    std::vector<State> tracePath(const State &last, int depth)
+    {
+        std::vector<State> path(1, last);
+        std::vector<Move> moves;
+        for(int d = depth - 1; d >= 0; --d){
+            const State &current = path.back();
+            moves.clear();
+            current.moves(m_map, moves);
+            for(const Move &move : moves){
+                State previous = current;
+                previous.play(move);
+                if(layerContains(d, previous.key(m_map.encoder()))){
+                    path.push_back(previous);
+                    break;
+                }
+            }
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    Map &m_map;
+    State m_start;
+    std::string m_prefix;
+    std::vector<StateKey> m_buffer;
+    size_t m_bufferKeys;
+    int m_runCount;
+    int m_layerCount;
+};
+
+}
+
+SearchResult externalBreadthFirstSearch(Map &map, const State &start, const std::string &directory,
+                                        size_t memoryMegabytes)
+{
+    LayeredSearch search(map, start, directory, memoryMegabytes);
+    return search.run();
+}
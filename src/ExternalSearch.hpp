@@ -0,0 +1,28 @@
+#ifndef EXTERNALSEARCH_HPP
+#define EXTERNALSEARCH_HPP
+
+#include <string>
+#include <cstddef>
+#include "Search.hpp"
+
+/**
+ * @brief externalBreadthFirstSearch finds the shortest solution as
+ * breadthFirstSearch, keeping the layers on disk instead of in memory.
+ * Each layer is a file of sorted packed states. The successors of a
+ * layer are gathered in a buffer, which is sorted and written as a run
+ * file whenever it is full. The runs are then merged, skipping the
+ * duplicates and the states of the two previous layers (a move can
+ * always be undone, so a successor is either new or one of these), and
+ * the result is the next layer. All the reads and writes are sequential,
+ * except for the few lookups rebuilding the solution from the layers
+ * @param map the map to solve, used as the working board
+ * @param start the starting state
+ * @param directory the folder where the layers and runs are written,
+ * the files are removed at the end of the search
+ * @param memoryMegabytes the size of the buffer of successors
+ * @return the result of the search
+ */
+SearchResult externalBreadthFirstSearch(Map &map, const State &start, const std::string &directory,
+                                        size_t memoryMegabytes);
+
+#endif // EXTERNALSEARCH_HPP
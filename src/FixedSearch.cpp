@@ -0,0 +1,21 @@
+#include "FixedSearch.hpp"
+
+SearchResult specializedBreadthFirstSearch(Map &map, const State &start)
+{
+    SearchTree tree(100000);
+    return specializedBreadthFirstSearch(map, start, tree);
+}
+
+SearchResult specializedBreadthFirstSearch(Map &map, const State &start, SearchTree &tree)
+{
+    if(FixedSearch<8, 8, 12>::fits(map, start)){
+        return FixedSearch<8, 8, 12>(map, start).run(tree);
+    }
+    if(FixedSearch<8, 8, MAX_CARS>::fits(map, start)){
+        return FixedSearch<8, 8, MAX_CARS>(map, start).run(tree);
+    }
+    if(FixedSearch<10, 10, MAX_CARS>::fits(map, start)){
+        return FixedSearch<10, 10, MAX_CARS>(map, start).run(tree);
+    }
+    return breadthFirstSearch(map, start, tree);
+}
@@ -0,0 +1,388 @@
+#ifndef FIXEDSEARCH_HPP
+#define FIXEDSEARCH_HPP
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "Map.hpp"
+#include "Search.hpp"
+#include "SearchTree.hpp"
+#include "SearchStats.hpp"
+#include "FreeRuns.hpp"
+
+/**
+ * @brief The FixedSearch class a breadth-first search for maps of
+ * a size known at compile time. The states are expanded as arrays of
+ * Cars origins (the cars missing from the map never move), and stored
+ * packed in a SearchTree. The board
+ * is rebuilt from the walls and the precomputed masks of the cars
+ * for every state, in a 64 bits mask when the map is small enough,
+ * the moves of all the cars being then computed at once by freeRuns.
+ * The loops over the cells have a constant trip count, so the compiler
+ * can unroll them, as the loops over the cars for the instances with
+ * few cars, see loopCars
+ */
+template<int Width, int Height, int Cars>
+class FixedSearch
+{
+public:
+    /**
+     * @brief Mask the occupancy of the board, one bit per cell
+     */
+    typedef typename std::conditional<Width * Height <= 64, uint64_t, BitMask>::type Mask;
+
+    /**
+     * @brief Origins a state : the origin of every car, in the order of the State's cars
+     */
+    typedef std::array<int8, Cars> Origins;
+
+    /**
+     * @brief fits wether this search can solve the given puzzle
+     * @param map the map to solve
+     * @param start the starting state
+     * @return wether the map has the size of this search and not too many cars
+     */
+    static bool fits(const Map &map, const State &start)
+    {
+        return map.width() == Width && map.height() == Height && start.carCount() <= Cars;
+    }
+
+    /**
+     * @brief FixedSearch constructor, copies the tables of the
+     * cars from the map, the puzzle must fit this search
+     * @param map the map to solve
+     * @param start the starting state
+     */
+    FixedSearch(const Map &map, const State &start):
+        m_tracks(),
+        m_shifts(),
+        m_masks(),
+        m_behind(),
+        m_ahead(),
+        m_solved(),
+        m_runTable(),
+        m_wallRows(static_cast<Mask>(map.walls().rows())),
+        m_wallColumns(static_cast<Mask>(map.walls().columns())),
+        m_start(),
+        m_first(start),
+        m_carCount(start.carCount())
+    {
+        // The missing cars stay at origin 1, with empty masks and no free cell
+        m_start.fill(1);
+        for(Track &track : m_tracks) track.lastOrigin = 1;
+
+        for(int c = 0; c < m_carCount; ++c){
+            const StateCar &car = start.car(c);
+            const CarTrack &source = map.track(car.code);
+            Track &track = m_tracks[c];
+            track.lineStart = source.lineStart;
+            track.length = source.length;
+            track.lastOrigin = source.lastOrigin;
+            track.vertical = source.vertical;
+            for(int origin = 0; origin < LINE; ++origin){
+                track.rows[origin] = static_cast<Mask>(source.rows[origin]);
+                track.columns[origin] = static_cast<Mask>(source.columns[origin]);
+                m_behind[c * LINE + origin] = static_cast<Mask>(source.behind[origin]);
+                m_ahead[c * LINE + origin] = static_cast<Mask>(source.ahead[origin]);
+            }
+            m_shifts[c] = map.encoder().shift(c);
+            m_masks[c] = map.encoder().mask(c);
+            m_start[c] = car.origin;
+        }
+
+        if constexpr(std::is_same<Mask, uint64_t>::value){
+            buildRunTable(map, start, LINE, m_behind.data(), m_ahead.data(), m_runTable);
+        }
+
+        const StateCar &mainCar = start.car(0);
+        const MapCar &mainData = map.getCarData(mainCar.code);
+        for(int origin = 1; origin <= m_tracks[0].lastOrigin; ++origin){
+            StateCar placed(mainCar.code, origin);
+            m_solved[origin] = mainData.originEnd(placed, 1) == map.exit() ||
+                    mainData.otherEnd(placed) == map.exit();
+        }
+    }
+
+    // The table given to freeRuns points to the masks of this search
+    FixedSearch(const FixedSearch &) = delete;
+    FixedSearch &operator=(const FixedSearch &) = delete;
+
+    /**
+     * @brief run finds the shortest solution, exploring the states nearest first
+     * @return the result of the search
+     */
+    SearchResult run()
+    {
+        SearchTree tree(100000);
+        return run(tree);
+    }
+
+    /**
+     * @brief run as run, storing the states in the given tree, which is cleared first
+     * @param tree the tree to store the states in
+     * @return the result of the search
+     */
+    SearchResult run(SearchTree &tree)
+    {
+        SearchResult result;
+        tree.clear();
+        tree.insert(key(m_start), SearchTree::NO_PARENT, Move());
+
+        SearchStats *stats = SearchStats::current();
+        size_t layerStart = 0;
+        size_t layerEnd = 1;
+        int depth = 0;
+        if(stats) stats->beginLayer(depth, 1);
+
+        FreeRuns runs;
+        size_t cursor = 0;
+        while(cursor < tree.size()){
+            if(cursor == layerEnd){
+                if(stats){
+                    stats->endLayer(layerEnd - layerStart, tree.size() - layerEnd, tree.memoryBytes());
+                    stats->beginLayer(++depth, tree.size() - layerEnd);
+                }
+                layerStart = layerEnd;
+                layerEnd = tree.size();
+            }
+            Origins current = origins(tree.key(cursor));
+            if(m_solved[current[0]]){
+                result.found = true;
+                result.path = tree.path(m_first, cursor);
+                break;
+            }
+
+            Mask rows = m_wallRows;
+            Mask columns = m_wallColumns;
+            for(int c = 0; c < loopCars(); ++c){
+                rows |= m_tracks[c].rows[current[c]];
+                columns |= m_tracks[c].columns[current[c]];
+            }
+
+            int generated = 0;
+            if constexpr(std::is_same<Mask, uint64_t>::value){
+                freeRuns(m_runTable, rows, columns, current.data(), runs);
+                for(int c = 0; c < m_carCount; ++c){
+                    generated += expandCar(tree, cursor, current, c, runs.before[c], runs.after[c]);
+                }
+            } else {
+                for(int c = 0; c < loopCars(); ++c){
+                    Mask lines = m_tracks[c].vertical ? columns : rows;
+                    int before = freeBefore(c, lines, current[c]);
+                    int after = freeAfter(c, lines, current[c]);
+                    generated += expandCar(tree, cursor, current, c, before, after);
+                }
+            }
+            RUSHHOUR_STATS_GENERATED(generated);
+            cursor++;
+        }
+        if(stats) stats->endLayer(cursor - layerStart, tree.size() - layerEnd, tree.memoryBytes());
+        result.explored = cursor;
+        return result;
+    }
+
+private:
+    /**
+     * @brief LINE number of origins stored for every car
+     */
+    static const int LINE = Width > Height ? Width : Height;
+    static_assert(LINE <= MAX_LINE, "The tracks of the cars hold MAX_LINE origins");
+
+    /**
+     * @brief UNROLLED_CARS up to this number of cars, the loops over the cars
+     * go over all of them, the missing cars included, to be unrolled
+     */
+    static const int UNROLLED_CARS = 16;
+
+    /**
+     * @brief loopCars number of cars the loops over the cars go over :
+     * Cars when they can be unrolled, else only the cars of the map,
+     * the instances for many cars holding mostly missing ones
+     * @return the bound of the loops over the cars
+     */
+    int loopCars() const
+    {
+        return Cars <= UNROLLED_CARS ? Cars : m_carCount;
+    }
+
+    /**
+     * @brief The Track struct the CarTrack of a car, narrowed to the mask
+     * of this search (the cells behind and ahead of the car are in m_behind
+     * and m_ahead)
+     */
+    struct Track{
+        Mask rows[LINE];
+        Mask columns[LINE];
+        int8 lineStart;
+        int8 length;
+        int8 lastOrigin;
+        bool vertical;
+    };
+
+    /**
+     * @brief key packs the state the same way State::key does
+     * (the missing cars have an empty field)
+     * @param origins the state to pack
+     * @return the packed state
+     */
+    StateKey key(const Origins &origins) const
+    {
+        StateKey packed = KEY_MARKER;
+        for(int c = 0; c < loopCars(); ++c){
+            packed |= static_cast<StateKey>(origins[c] - 1) << m_shifts[c];
+        }
+        return packed;
+    }
+
+    /**
+     * @brief origins unpacks a state packed by key
+     * @param packed the packed state
+     * @return the origin of every car, the missing cars staying at origin 1
+     */
+    Origins origins(StateKey packed) const
+    {
+        Origins result = m_start;
+        for(int c = 0; c < loopCars(); ++c){
+            result[c] = static_cast<int8>((static_cast<uint32_t>(packed >> m_shifts[c]) & m_masks[c]) + 1);
+        }
+        return result;
+    }
+
+    /**
+     * @brief expandCar adds to the tree the states reached by sliding a car
+     * @param tree the tree of the search
+     * @param parent the node of the state expanded
+     * @param current the state expanded, left as it was
+     * @param car the index of the car
+     * @param before the distance the car can slide backward
+     * @param after the distance the car can slide forward
+     * @return the number of moves of the car
+     */
+    int expandCar(SearchTree &tree, size_t parent, Origins &current, int car, int before, int after) const
+    {
+        int8 origin = current[car];
+        for(int i = -before; i <= after; ++i){
+            if(i == 0) continue;
+            current[car] = origin + i;
+            tree.insert(key(current), static_cast<int32_t>(parent), Move(car, i));
+        }
+        current[car] = origin;
+        return before + after;
+    }
+
+    /**
+     * @brief freeBefore as Bitboard::freeBefore, on the mask of this search
+     * @param car the index of the car
+     * @param lines the occupancy where the track of the car is contiguous
+     * @param origin the position of the car
+     * @return the maximum distance the car can move backward
+     */
+    int freeBefore(int car, Mask lines, int origin) const
+    {
+        const Track &track = m_tracks[car];
+        Mask blocked = lines & m_behind[car * LINE + origin];
+        if(!blocked) return origin - 1;
+        return track.lineStart + origin - highestBit(blocked) - 1;
+    }
+
+    /**
+     * @brief freeAfter as Bitboard::freeAfter, on the mask of this search
+     * @param car the index of the car
+     * @param lines the occupancy where the track of the car is contiguous
+     * @param origin the position of the car
+     * @return the maximum distance the car can move forward
+     */
+    int freeAfter(int car, Mask lines, int origin) const
+    {
+        const Track &track = m_tracks[car];
+        Mask blocked = lines & m_ahead[car * LINE + origin];
+        if(!blocked) return track.lastOrigin - origin;
+        return lowestBit(blocked) - (track.lineStart + origin + track.length);
+    }
+
+    /**
+     * @brief m_tracks the tables of the cars, in the order of the State's cars
+     */
+    std::array<Track, Cars> m_tracks;
+
+    /**
+     * @brief m_shifts the position of the field of every car in the packed states
+     */
+    std::array<int, Cars> m_shifts;
+
+    /**
+     * @brief m_masks the mask of the field of every car in the packed states
+     */
+    std::array<uint32_t, Cars> m_masks;
+
+    /**
+     * @brief m_behind the cells of a car's line behind it, car c at origin o being
+     * at c * LINE + o, a single array so that freeRuns can go through all the cars
+     */
+    std::array<Mask, Cars * LINE> m_behind;
+
+    /**
+     * @brief m_ahead the cells of a car's line ahead of it, as m_behind
+     */
+    std::array<Mask, Cars * LINE> m_ahead;
+
+    /**
+     * @brief m_solved wether the main car is next to the exit, for every origin
+     */
+    std::array<bool, LINE> m_solved;
+
+    /**
+     * @brief m_runTable the tables of the cars given to freeRuns, for the 64 bits masks
+     */
+    RunTable m_runTable;
+
+    /**
+     * @brief m_wallRows the walls of the map, row-major
+     */
+    Mask m_wallRows;
+
+    /**
+     * @brief m_wallColumns the walls of the map, column-major
+     */
+    Mask m_wallColumns;
+
+    /**
+     * @brief m_start the starting state
+     */
+    Origins m_start;
+
+    /**
+     * @brief m_first the starting state, to rebuild the solution
+     */
+    State m_first;
+
+    /**
+     * @brief m_carCount number of cars of the map, including the main car
+     */
+    int m_carCount;
+};
+
+/**
+ * @brief specializedBreadthFirstSearch finds the shortest solution
+ * as breadthFirstSearch, with the FixedSearch instance matching the
+ * size of the map (8x8 for the classic 6x6 puzzles, with up to 12
+ * cars or more, 10x10 for the 8x8 ones), or breadthFirstSearch if there
+ * is none
+ * @param map the map to solve
+ * @param start the starting state
+ * @return the result of the search
+ */
+SearchResult specializedBreadthFirstSearch(Map &map, const State &start);
+
+/**
+ * @brief specializedBreadthFirstSearch as specializedBreadthFirstSearch,
+ * storing the states in the given tree, which is cleared first
+ * @param map the map to solve
+ * @param start the starting state
+ * @param tree the tree to store the states in
+ * @return the result of the search
+ */
+SearchResult specializedBreadthFirstSearch(Map &map, const State &start, SearchTree &tree);
+
+#endif // FIXEDSEARCH_HPP
@@ -0,0 +1,269 @@
+#include "FreeRuns.hpp"
+#include "Map.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RUSHHOUR_X86
+#endif
+
+namespace {
+
+/**
+ * @brief scalarRuns freeRuns for the cars from the given one, one car at a time
+ * @param table the tables of the cars
+ * @param rows the occupancy of the board, row-major
+ * @param columns the occupancy of the board, column-major
+ * @param origins the origin of every car
+ * @param runs the distances computed
+ * @param from the first car to handle
+ */
+void scalarRuns(const RunTable &table, uint64_t rows, uint64_t columns, const int8 *origins,
+                FreeRuns &runs, int from)
+{
+    for(int c = from; c < table.count; ++c){
+        int64_t origin = origins[c];
+        uint64_t vertical = static_cast<uint64_t>(table.vertical[c]);
+        uint64_t lines = (rows & ~vertical) | (columns & vertical);
+        uint64_t behind = lines & table.behind[c * table.stride + origin];
+        uint64_t ahead = lines & table.ahead[c * table.stride + origin];
+        int64_t highest = behind ? 63 - __builtin_clzll(behind) : -1;
+        int64_t lowest = ahead ? __builtin_ctzll(ahead) : 64;
+        int64_t first = table.lineStart[c] + origin;
+        runs.before[c] = first - 1 - std::max(highest, table.lineStart[c]);
+        runs.after[c] = std::min(lowest, table.lineEnd[c]) - (first + table.length[c]);
+    }
+}
+
+void scalarKernel(const RunTable &table, uint64_t rows, uint64_t columns, const int8 *origins, FreeRuns &runs)
+{
+    scalarRuns(table, rows, columns, origins, runs, 0);
+}
+
+#ifdef RUSHHOUR_X86
+
+/**
+ * @brief popcount256 number of bits set in every 64 bits lane,
+ * by looking up the bits of every nibble in a table
+ * @param v the lanes to count
+ * @return the counts
+ */
+__attribute__((target("avx2"))) inline __m256i popcount256(__m256i v)
+{
+    const __m256i nibbleBits = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+    __m256i low = _mm256_shuffle_epi8(nibbleBits, _mm256_and_si256(v, lowNibbles));
+    __m256i high = _mm256_shuffle_epi8(nibbleBits, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibbles));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2"))) void avx2Kernel(const RunTable &table, uint64_t rows, uint64_t columns,
+                                                const int8 *origins, FreeRuns &runs)
+{
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i rowMasks = _mm256_set1_epi64x(static_cast<long long>(rows));
+    const __m256i columnMasks = _mm256_set1_epi64x(static_cast<long long>(columns));
+    const long long *behindTable = reinterpret_cast<const long long *>(table.behind);
+    const long long *aheadTable = reinterpret_cast<const long long *>(table.ahead);
+    __m256i carStart = _mm256_setr_epi64x(0, table.stride, 2 * table.stride, 3 * table.stride);
+    const __m256i nextCars = _mm256_set1_epi64x(4 * table.stride);
+
+    int c = 0;
+    for(; c + 4 <= table.count; c += 4, carStart = _mm256_add_epi64(carStart, nextCars)){
+        int32_t packed;
+        std::memcpy(&packed, origins + c, sizeof(packed));
+        __m256i origin = _mm256_cvtepi8_epi64(_mm_cvtsi32_si128(packed));
+        __m256i index = _mm256_add_epi64(carStart, origin);
+        __m256i vertical = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&table.vertical[c]));
+        __m256i lines = _mm256_blendv_epi8(rowMasks, columnMasks, vertical);
+        __m256i behind = _mm256_and_si256(lines, _mm256_i64gather_epi64(behindTable, index, 8));
+        __m256i ahead = _mm256_and_si256(lines, _mm256_i64gather_epi64(aheadTable, index, 8));
+
+        // Once smeared down, the mask has one bit more than the index of its highest bit
+        behind = _mm256_or_si256(behind, _mm256_srli_epi64(behind, 1));
+        behind = _mm256_or_si256(behind, _mm256_srli_epi64(behind, 2));
+        behind = _mm256_or_si256(behind, _mm256_srli_epi64(behind, 4));
+        behind = _mm256_or_si256(behind, _mm256_srli_epi64(behind, 8));
+        behind = _mm256_or_si256(behind, _mm256_srli_epi64(behind, 16));
+        behind = _mm256_or_si256(behind, _mm256_srli_epi64(behind, 32));
+        __m256i highest = _mm256_sub_epi64(popcount256(behind), one);
+        // The bits below the lowest one, 64 when the mask is empty
+        __m256i lowest = popcount256(_mm256_andnot_si256(ahead, _mm256_sub_epi64(ahead, one)));
+
+        // All the values are small, the 32 bits comparisons give the 64 bits ones
+        __m256i lineStart = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&table.lineStart[c]));
+        __m256i lineEnd = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&table.lineEnd[c]));
+        __m256i length = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&table.length[c]));
+        __m256i first = _mm256_add_epi64(lineStart, origin);
+        __m256i before = _mm256_sub_epi64(_mm256_sub_epi64(first, one), _mm256_max_epi32(highest, lineStart));
+        __m256i after = _mm256_sub_epi64(_mm256_min_epi32(lowest, lineEnd), _mm256_add_epi64(first, length));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&runs.before[c]), before);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&runs.after[c]), after);
+    }
+    scalarRuns(table, rows, columns, origins, runs, c);
+}
+
+/**
+ * @brief popcount128 as popcount256, on 2 lanes
+ * @param v the lanes to count
+ * @return the counts
+ */
+__attribute__((target("sse4.1"))) inline __m128i popcount128(__m128i v)
+{
+    const __m128i nibbleBits = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i lowNibbles = _mm_set1_epi8(0x0f);
+    __m128i low = _mm_shuffle_epi8(nibbleBits, _mm_and_si128(v, lowNibbles));
+    __m128i high = _mm_shuffle_epi8(nibbleBits, _mm_and_si128(_mm_srli_epi16(v, 4), lowNibbles));
+    return _mm_sad_epu8(_mm_add_epi8(low, high), _mm_setzero_si128());
+}
+
+__attribute__((target("sse4.1"))) void sse41Kernel(const RunTable &table, uint64_t rows, uint64_t columns,
+                                                   const int8 *origins, FreeRuns &runs)
+{
+    const __m128i one = _mm_set1_epi64x(1);
+    const __m128i rowMasks = _mm_set1_epi64x(static_cast<long long>(rows));
+    const __m128i columnMasks = _mm_set1_epi64x(static_cast<long long>(columns));
+
+    int c = 0;
+    for(; c + 2 <= table.count; c += 2){
+        int first0 = c * table.stride + origins[c];
+        int first1 = (c + 1) * table.stride + origins[c + 1];
+        __m128i origin = _mm_set_epi64x(origins[c + 1], origins[c]);
+        __m128i vertical = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&table.vertical[c]));
+        __m128i lines = _mm_blendv_epi8(rowMasks, columnMasks, vertical);
+        __m128i behind = _mm_and_si128(lines, _mm_set_epi64x(static_cast<long long>(table.behind[first1]),
+                                                             static_cast<long long>(table.behind[first0])));
+        __m128i ahead = _mm_and_si128(lines, _mm_set_epi64x(static_cast<long long>(table.ahead[first1]),
+                                                            static_cast<long long>(table.ahead[first0])));
+
+        behind = _mm_or_si128(behind, _mm_srli_epi64(behind, 1));
+        behind = _mm_or_si128(behind, _mm_srli_epi64(behind, 2));
+        behind = _mm_or_si128(behind, _mm_srli_epi64(behind, 4));
+        behind = _mm_or_si128(behind, _mm_srli_epi64(behind, 8));
+        behind = _mm_or_si128(behind, _mm_srli_epi64(behind, 16));
+        behind = _mm_or_si128(behind, _mm_srli_epi64(behind, 32));
+        __m128i highest = _mm_sub_epi64(popcount128(behind), one);
+        __m128i lowest = popcount128(_mm_andnot_si128(ahead, _mm_sub_epi64(ahead, one)));
+
+        __m128i lineStart = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&table.lineStart[c]));
+        __m128i lineEnd = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&table.lineEnd[c]));
+        __m128i length = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&table.length[c]));
+        __m128i first = _mm_add_epi64(lineStart, origin);
+        __m128i before = _mm_sub_epi64(_mm_sub_epi64(first, one), _mm_max_epi32(highest, lineStart));
+        __m128i after = _mm_sub_epi64(_mm_min_epi32(lowest, lineEnd), _mm_add_epi64(first, length));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&runs.before[c]), before);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&runs.after[c]), after);
+    }
+    scalarRuns(table, rows, columns, origins, runs, c);
+}
+
+#endif
+
+/**
+ * @brief The Kernel struct a version of freeRuns
+ */
+struct Kernel{
+    void (*run)(const RunTable &, uint64_t, uint64_t, const int8 *, FreeRuns &);
+    const char *name;
+};
+
+/**
+ * @brief supportedKernels all the versions of freeRuns the processor supports, best first
+ * @return the versions
+ */
+std::vector<Kernel> supportedKernels()
+{
+    std::vector<Kernel> kernels;
+#ifdef RUSHHOUR_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) kernels.push_back(Kernel{avx2Kernel, "avx2"});
+    if(__builtin_cpu_supports("sse4.1")) kernels.push_back(Kernel{sse41Kernel, "sse4.1"});
+#endif
+    kernels.push_back(Kernel{scalarKernel, "scalar"});
+    return kernels;
+}
+
+/**
+ * @brief pickKernel the best version of freeRuns the processor supports, the
+ * RUSHHOUR_FREERUNS environment variable can force "scalar" or "sse4.1"
+ * @return the version to use
+ */
+Kernel pickKernel()
+{
+    const char *forced = std::getenv("RUSHHOUR_FREERUNS");
+    std::string wanted = forced ? forced : "";
+#ifdef RUSHHOUR_X86
+    __builtin_cpu_init();
+    if(wanted.empty() || wanted == "avx2"){
+        if(__builtin_cpu_supports("avx2")) return Kernel{avx2Kernel, "avx2"};
+    }
+    if(wanted != "scalar"){
+        if(__builtin_cpu_supports("sse4.1")) return Kernel{sse41Kernel, "sse4.1"};
+    }
+#endif
+    return Kernel{scalarKernel, "scalar"};
+}
+
+/**
+ * @brief KERNEL the version of freeRuns used, picked once
+ */
+const Kernel KERNEL = pickKernel();
+
+/**
+ * @brief SUPPORTED all the versions of freeRuns the processor supports, listed once
+ */
+const std::vector<Kernel> SUPPORTED = supportedKernels();
+
+}
+
+void buildRunTable(const Map &map, const State &start, int stride, uint64_t *behind, uint64_t *ahead, RunTable &table)
+{
+    table.behind = behind;
+    table.ahead = ahead;
+    table.stride = stride;
+    table.count = start.carCount();
+    for(int c = 0; c < table.count; ++c){
+        const CarTrack &track = map.track(start.car(c).code);
+        for(int origin = 0; origin < stride; ++origin){
+            behind[c * stride + origin] = static_cast<uint64_t>(track.behind[origin]);
+            ahead[c * stride + origin] = static_cast<uint64_t>(track.ahead[origin]);
+        }
+        table.lineStart[c] = track.lineStart;
+        table.length[c] = track.length;
+        table.lineEnd[c] = track.lineStart + track.lastOrigin + track.length;
+        table.vertical[c] = track.vertical ? -1 : 0;
+    }
+}
+
+void freeRuns(const RunTable &table, uint64_t rows, uint64_t columns, const int8 *origins, FreeRuns &runs)
+{
+    KERNEL.run(table, rows, columns, origins, runs);
+}
+
+const char *freeRunsKernel()
+{
+    return KERNEL.name;
+}
+
+std::vector<std::string> freeRunsKernels()
+{
+    std::vector<std::string> names;
+    for(const Kernel &kernel : SUPPORTED) names.push_back(kernel.name);
+    return names;
+}
+
+bool freeRunsWith(const std::string &kernel, const RunTable &table, uint64_t rows, uint64_t columns,
+                  const int8 *origins, FreeRuns &runs)
+{
+    for(const Kernel &supported : SUPPORTED){
+        if(kernel != supported.name) continue;
+        supported.run(table, rows, columns, origins, runs);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,132 @@
+#ifndef FREERUNS_HPP
+#define FREERUNS_HPP
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Car.hpp"
+
+class Map;
+class State;
+
+/**
+ * @brief The RunTable struct what the free runs of the cars of a map
+ * need, for a board held in 64 bits masks, as arrays over the cars
+ * so that several cars are handled at once
+ */
+struct RunTable{
+    /**
+     * @brief behind the cells of a car's line behind it, car c at origin o
+     * being at behind[c * stride + o] (see CarTrack::behind), in a single
+     * array of count * stride masks
+     */
+    const uint64_t *behind;
+
+    /**
+     * @brief ahead the cells of a car's line ahead of it, as behind
+     */
+    const uint64_t *ahead;
+
+    /**
+     * @brief stride number of masks of every car in behind and ahead,
+     * more than the last origin of every car
+     */
+    int stride;
+
+    /**
+     * @brief count number of cars
+     */
+    int count;
+
+    /**
+     * @brief lineStart the index of the cell before origin 1 of every car
+     */
+    std::array<int64_t, MAX_CARS> lineStart;
+
+    /**
+     * @brief length the length of every car
+     */
+    std::array<int64_t, MAX_CARS> length;
+
+    /**
+     * @brief lineEnd the cell after the car at its last origin, for every car
+     */
+    std::array<int64_t, MAX_CARS> lineEnd;
+
+    /**
+     * @brief vertical all the bits set for the vertical cars, none for the others
+     */
+    std::array<int64_t, MAX_CARS> vertical;
+};
+
+/**
+ * @brief The FreeRuns struct how far every car can slide
+ */
+struct FreeRuns{
+    /**
+     * @brief before the distance every car can slide backward (left or up)
+     */
+    std::array<int64_t, MAX_CARS> before;
+
+    /**
+     * @brief after the distance every car can slide forward (right or down)
+     */
+    std::array<int64_t, MAX_CARS> after;
+};
+
+/**
+ * @brief buildRunTable fills the tables of the cars of a map whose board
+ * fits in 64 bits, used by FixedSearch and checked by the benchmark
+ * @param map the map of the cars
+ * @param start a state of the map, giving the order of the cars
+ * @param stride number of origins stored for every car, at most MAX_LINE
+ * @param behind the array filled with the masks behind the cars, of carCount * stride masks
+ * @param ahead the array filled with the masks ahead of the cars, as behind
+ * @param table the table filled, pointing to behind and ahead
+ */
+void buildRunTable(const Map &map, const State &start, int stride, uint64_t *behind, uint64_t *ahead, RunTable &table);
+
+/**
+ * @brief freeRuns computes how far every car can slide, as Bitboard::freeBefore
+ * and Bitboard::freeAfter, for all the cars at once. The cells of a car's line
+ * blocking it are its line's occupancy masked by the cells behind or ahead of it,
+ * the nearest one is found without branching : the highest bit behind is one
+ * less than the number of bits once the mask is smeared down, the lowest bit ahead
+ * is the number of bits below it. The cars are handled 4 at a time with AVX2,
+ * 2 at a time with SSE4.1, or one by one, whichever the processor supports
+ * @param table the tables of the cars
+ * @param rows the occupancy of the board, row-major, used by the horizontal cars
+ * @param columns the occupancy of the board, column-major, used by the vertical cars
+ * @param origins the origin of every car
+ * @param runs the distances computed
+ */
+void freeRuns(const RunTable &table, uint64_t rows, uint64_t columns, const int8 *origins, FreeRuns &runs);
+
+/**
+ * @brief freeRunsKernel name of the version of freeRuns picked for this processor
+ * @return "avx2", "sse4.1" or "scalar"
+ */
+const char *freeRunsKernel();
+
+/**
+ * @brief freeRunsKernels names of all the versions of freeRuns this processor supports
+ * @return the names, the one freeRuns picks when nothing is forced first
+ */
+std::vector<std::string> freeRunsKernels();
+
+/**
+ * @brief freeRunsWith as freeRuns, with the version of the given name, so
+ * that the versions can be checked against each other
+ * @param kernel the name of the version, one of freeRunsKernels
+ * @param table the tables of the cars
+ * @param rows the occupancy of the board, row-major, used by the horizontal cars
+ * @param columns the occupancy of the board, column-major, used by the vertical cars
+ * @param origins the origin of every car
+ * @param runs the distances computed
+ * @return false if the processor doesn't support this version
+ */
+bool freeRunsWith(const std::string &kernel, const RunTable &table, uint64_t rows, uint64_t columns,
+                  const int8 *origins, FreeRuns &runs);
+
+#endif // FREERUNS_HPP
@@ -0,0 +1,214 @@
+#include "FrontierSearch.hpp"
+#include "Map.hpp"
+#include "StateSet.hpp"
+#include "SearchStats.hpp"
+
+#include <array>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief The Layer struct the states at the same depth, in the order
+ * they were found, and in a set to detect the duplicates
+ */
+struct Layer{
+
+    /**
+     * @brief clear removes all the states, but keeps the memory
+     */
+    void clear()
+    {
+        keys.clear();
+        set.clear();
+    }
+
+    /**
+     * @brief memoryBytes memory used by the layer
+     * @return the number of bytes
+     */
+    size_t memoryBytes() const
+    {
+        return keys.capacity() * sizeof(StateKey) + set.memoryBytes();
+    }
+
+    std::vector<StateKey> keys;
+    StateSet set;
+};
+
+/**
+ * @brief The FrontierSearch class the layers of a breadth-first
+ * search from any state, the three layers are reused from one
+ * search to the other
+ */
+class FrontierSearch
+{
+public:
+    /**
+     * @brief FrontierSearch constructor
+     * @param map the map to solve, used as the working board
+     */
+    explicit FrontierSearch(Map &map):
+        m_map(map),
+        m_layers(),
+        m_previous(&m_layers[0]),
+        m_current(&m_layers[1]),
+        m_next(&m_layers[2]),
+        m_moves(),
+        m_explored(0)
+    {
+    }
+
+    /**
+     * @brief run searches the nearest solved state, then rebuilds the path to it
+     * @param start the starting state
+     * @return the result of the search
+     */
+    SearchResult run(const State &start)
+    {
+        SearchResult result;
+        SearchStats *stats = SearchStats::current();
+        State solution;
+        int depth = 0;
+        restart(start);
+        while(!m_current->keys.empty()){
+            size_t layerSize = m_current->keys.size();
+            if(stats) stats->beginLayer(depth, layerSize);
+            result.found = expand(&solution);
+            if(stats){
+                size_t expanded = result.found ? 0 : layerSize;
+                stats->endLayer(expanded, result.found ? 0 : m_current->keys.size(), memoryBytes());
+            }
+            if(result.found) break;
+            depth++;
+        }
+        if(result.found){
+            result.path.push_back(start);
+            bridge(start, solution, depth, result.path);
+        }
+        result.explored = m_explored;
+        return result;
+    }
+
+private:
+    /**
+     * @brief restart empties the layers, the first one only holding the origin
+     * @param origin the state the search starts from
+     */
+    void restart(const State &origin)
+    {
+        m_previous->clear();
+        m_current->clear();
+        m_next->clear();
+        StateKey key = origin.key(m_map.encoder());
+        m_current->keys.push_back(key);
+        m_current->set.insert(key);
+    }
+
+    /**
+     * @brief expand builds the next layer from the current one, and makes it
+     * the current layer, the layer before the current one is dropped
+     * @param solution if not null, the expansion stops at the first solved state
+     * of the current layer, which is copied there, and the layers are left as they are
+     * @return wether a solved state was found
+     */
+    bool expand(State *solution)
+    {
+        const StateEncoder &encoder = m_map.encoder();
+        size_t generated = 0;
+        for(StateKey key : m_current->keys){
+            State current = State::fromKey(key, encoder);
+            if(solution && current.isSolutionOf(m_map)){
+                *solution = current;
+                RUSHHOUR_STATS_GENERATED(generated);
+                return true;
+            }
+            m_explored++;
+            m_moves.clear();
+            current.moves(m_map, m_moves);
+            generated += m_moves.size();
+            for(const Move &move : m_moves){
+                State next = current;
+                next.play(move);
+                StateKey nextKey = next.key(encoder);
+                if(m_previous->set.contains(nextKey) || m_current->set.contains(nextKey)) continue;
+                if(m_next->set.insert(nextKey)) m_next->keys.push_back(nextKey);
+            }
+        }
+        RUSHHOUR_STATS_GENERATED(generated);
+        std::swap(m_previous, m_current);
+        std::swap(m_current, m_next);
+        m_next->clear();
+        return false;
+    }
+
+    /**
+     * @brief layerAt the states at the given distance of a state
+     * @param origin the state the search starts from
+     * @param distance the number of moves from the origin
+     * @return the packed states of the layer
+     */
+    const std::vector<StateKey> &layerAt(const State &origin, int distance)
+    {
+        restart(origin);
+        for(int d = 0; d < distance; ++d) expand(nullptr);
+        return m_current->keys;
+    }
+
+    /**
+     * @brief bridge appends the shortest path between two states to the path,
+     * the state in the middle of the path is one of the states at half the
+     * distance of the first state that is also at the rest of the distance
+     * of the last one, both halves are then bridged the same way
+     * @param from the first state, already in the path
+     * @param to the last state
+     * @param distance the number of moves between them
+     * @param path the path to complete, ends with the last state afterward
+     */
+    void bridge(const State &from, const State &to, int distance, std::vector<State> &path)
+    {
+        if(distance == 0) return;
+        if(distance == 1){
+            path.push_back(to);
+            return;
+        }
+        int half = distance / 2;
+        std::vector<StateKey> middle = layerAt(from, half);
+        std::sort(middle.begin(), middle.end());
+
+        const std::vector<StateKey> &backward = layerAt(to, distance - half);
+        auto meeting = std::find_if(backward.begin(), backward.end(), [&](StateKey key){
+            return std::binary_search(middle.begin(), middle.end(), key);
+        });
+        State halfway = State::fromKey(*meeting, m_map.encoder());
+        std::vector<StateKey>().swap(middle);
+
+        bridge(from, halfway, half, path);
+        bridge(halfway, to, distance - half, path);
+    }
+
+    /**
+     * @brief memoryBytes memory used by the layers
+     * @return the number of bytes
+     */
+    size_t memoryBytes() const
+    {
+        return m_layers[0].memoryBytes() + m_layers[1].memoryBytes() + m_layers[2].memoryBytes();
+    }
+
+    Map &m_map;
+    std::array<Layer, 3> m_layers;
+    Layer *m_previous;
+    Layer *m_current;
+    Layer *m_next;
+    std::vector<Move> m_moves;
+    size_t m_explored;
+};
+
+}
+
+SearchResult frontierBreadthFirstSearch(Map &map, const State &start)
+{
+    FrontierSearch search(map);
+    return search.run(start);
+}
@@ -0,0 +1,22 @@
+#ifndef FRONTIERSEARCH_HPP
+#define FRONTIERSEARCH_HPP
+
+#include "Search.hpp"
+
+/**
+ * @brief frontierBreadthFirstSearch finds the shortest solution as
+ * breadthFirstSearch, keeping only the layer being expanded, the one
+ * before it and the one being built. Since every move can be undone,
+ * the successors of a layer are either new or in one of these layers,
+ * so the older layers are dropped and the memory is about three times
+ * the widest layer. Without parent links, the path is rebuilt by divide
+ * and conquer : a state in the middle of the solution is found where the
+ * layers searched from both of its ends meet, and each half is solved
+ * the same way, which explores the states again a logarithmic number of times
+ * @param map the map to solve, used as the working board
+ * @param start the starting state
+ * @return the result of the search
+ */
+SearchResult frontierBreadthFirstSearch(Map &map, const State &start);
+
+#endif // FRONTIERSEARCH_HPP
@@ -0,0 +1,312 @@
+#include "Generator.hpp"
+#include "Map.hpp"
+#include "State.hpp"
+#include "StateSet.hpp"
+#include "DistanceTable.hpp"
+#include "ThreadPool.hpp"
+#include "Bitboard.hpp"
+
+#include <array>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief The Track struct the line a car slides on, and its length
+ */
+struct Track{
+    bool vertical;
+    int line;
+    int length;
+};
+
+/**
+ * @brief The TrackSetResult struct what the placements of a set of tracks gave
+ */
+struct TrackSetResult{
+    size_t layouts;
+    size_t clusters;
+    std::vector<GeneratedPuzzle> puzzles;
+};
+
+/**
+ * @brief listTracks all the tracks a car other than the main car can take,
+ * the exit row being left to the main car : a car lying there would either
+ * stand between the main car and the exit for ever, or never move it
+ * @param size the size of the map, borders included
+ * @param exitRow the row of the exit
+ * @return the tracks, rows first
+ */
+std::vector<Track> listTracks(int size, int exitRow)
+{
+    std::vector<Track> tracks;
+    for(int vertical = 0; vertical < 2; ++vertical){
+        for(int line = 1; line < size - 1; ++line){
+            if(!vertical && line == exitRow) continue;
+            for(int length = 2; length <= std::min(3, size - 2); ++length){
+                tracks.push_back(Track{vertical != 0, line, length});
+            }
+        }
+    }
+    return tracks;
+}
+
+/**
+ * @brief listTrackSets gathers the sets of tracks of the cars other than the
+ * main car, as sorted indexes in 'tracks', a line never holding more cars
+ * than it has cells
+ * @param tracks all the tracks
+ * @param first the lowest index the next car can take
+ * @param left the number of cars left to choose
+ * @param room the number of cells left on every line, vertical lines after the horizontal ones
+ * @param current the indexes chosen so far
+ * @param sets the sets found
+ */
+void listTrackSets(const std::vector<Track> &tracks, size_t first, int left, std::vector<int> &room,
+                   std::vector<uint8_t> &current, std::vector<std::vector<uint8_t>> &sets)
+{
+    if(!left){
+        sets.push_back(current);
+        return;
+    }
+    for(size_t t = first; t < tracks.size(); ++t){
+        int &free = room[tracks[t].vertical * room.size() / 2 + tracks[t].line];
+        if(free < tracks[t].length) continue;
+        free -= tracks[t].length;
+        current.push_back(static_cast<uint8_t>(t));
+        listTrackSets(tracks, t, left - 1, room, current, sets);
+        current.pop_back();
+        free += tracks[t].length;
+    }
+}
+
+/**
+ * @brief The TrackSetSearch class enumerates the placements of the
+ * cars of a set of tracks, and solves every cluster they form
+ */
+class TrackSetSearch
+{
+public:
+    /**
+     * @brief TrackSetSearch constructor
+     * @param options the puzzles looked for
+     * @param cars the track of every car, the main car first
+     * @param result where to count the work done and keep the puzzles found
+     */
+    TrackSetSearch(const GeneratorOptions &options, const std::vector<Track> &cars, TrackSetResult &result):
+        m_options(options),
+        m_cars(cars),
+        m_result(result),
+        m_map(),
+        m_visited(),
+        m_origins(),
+        m_cells()
+    {
+        for(size_t c = 0; c < m_cars.size(); ++c){
+            const Track &car = m_cars[c];
+            m_cells[c].assign(m_options.size - car.length, 0);
+            for(int origin = 1; origin < m_options.size - car.length; ++origin){
+                for(int i = 0; i < car.length; ++i){
+                    int x = car.vertical ? car.line : origin + i;
+                    int y = car.vertical ? origin + i : car.line;
+                    m_cells[c][origin] |= BitMask(1) << (y * m_options.size + x);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief run enumerates the placements, nothing is done
+     * when the cars can't be placed at all
+     */
+    void run()
+    {
+        if(!findFirst(0, 0)) return;
+        m_map = Map(m_options.size, m_options.size);
+        for(int y = 0; y < m_options.size; ++y){
+            for(int x = 0; x < m_options.size; ++x){
+                bool border = x == 0 || y == 0 || x == m_options.size - 1 || y == m_options.size - 1;
+                m_map.setValue(x, y, border ? 'x' : ' ');
+            }
+        }
+        m_map.setValue(m_options.size - 1, m_cars[0].line, 'z');
+        for(size_t c = 0; c < m_cars.size(); ++c){
+            char code = c < 23 ? static_cast<char>('a' + c) : 'y';
+            for(int i = 0; i < m_cars[c].length; ++i){
+                int x = m_cars[c].vertical ? m_cars[c].line : m_origins[c] + i;
+                int y = m_cars[c].vertical ? m_origins[c] + i : m_cars[c].line;
+                m_map.setValue(x, y, code);
+            }
+        }
+        State first;
+        first.extractFrom(m_map);
+        enumerate(0, 0);
+    }
+
+private:
+    /**
+     * @brief lowestOrigin the first origin a car can take : a car on the
+     * same track as the car before it stays after it, since they can't pass
+     * @param car the index of the car
+     * @return the origin
+     */
+    int lowestOrigin(size_t car) const
+    {
+        if(car == 0) return 1;
+        const Track &previous = m_cars[car - 1];
+        const Track &current = m_cars[car];
+        if(previous.vertical != current.vertical || previous.line != current.line ||
+           previous.length != current.length) return 1;
+        return m_origins[car - 1] + previous.length;
+    }
+
+    /**
+     * @brief findFirst finds the first placement of the cars
+     * @param car the car to place
+     * @param occupied the cells of the cars already placed
+     * @return wether the cars could be placed
+     */
+    bool findFirst(size_t car, BitMask occupied)
+    {
+        if(car == m_cars.size()) return true;
+        for(int origin = lowestOrigin(car); origin < m_options.size - m_cars[car].length; ++origin){
+            if(occupied & m_cells[car][origin]) continue;
+            m_origins[car] = origin;
+            if(findFirst(car + 1, occupied | m_cells[car][origin])) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief enumerate goes through all the placements of the cars
+     * @param car the car to place
+     * @param occupied the cells of the cars already placed
+     */
+    void enumerate(size_t car, BitMask occupied)
+    {
+        if(car == m_cars.size()){
+            layoutFound();
+            return;
+        }
+        for(int origin = lowestOrigin(car); origin < m_options.size - m_cars[car].length; ++origin){
+            if(occupied & m_cells[car][origin]) continue;
+            m_origins[car] = origin;
+            enumerate(car + 1, occupied | m_cells[car][origin]);
+        }
+    }
+
+    /**
+     * @brief layoutFound solves the cluster of the current placement,
+     * unless it was already reached from another placement
+     */
+    void layoutFound()
+    {
+        m_result.layouts++;
+        const StateEncoder &encoder = m_map.encoder();
+        StateKey key = KEY_MARKER;
+        for(size_t c = 0; c < m_cars.size(); ++c){
+            key |= static_cast<StateKey>(m_origins[c] - 1) << encoder.shift(static_cast<int>(c));
+        }
+        if(m_visited.contains(key)) return;
+
+        DistanceTable table(m_map, State::fromKey(key, encoder));
+        m_result.clusters++;
+        for(StateKey reached : table.keys()) m_visited.insert(reached);
+        if(table.maxDistance() < m_options.minMoves) return;
+
+        // The hardest state with the lowest key, so that the puzzle doesn't
+        // depend on the placement the cluster was found from
+        const std::vector<uint8_t> &distances = table.distances();
+        size_t hardest = std::find(distances.begin(), distances.end(), table.maxDistance()) - distances.begin();
+        m_map.placeState(State::fromKey(table.keys()[hardest], encoder));
+        GeneratedPuzzle puzzle;
+        puzzle.moves = table.maxDistance();
+        puzzle.clusterSize = table.size();
+        puzzle.text = std::to_string(m_options.size) + "," + std::to_string(m_options.size) + "\n" + m_map.toString();
+        m_result.puzzles.push_back(puzzle);
+    }
+
+    const GeneratorOptions &m_options;
+    const std::vector<Track> &m_cars;
+    TrackSetResult &m_result;
+    Map m_map;
+    StateSet m_visited;
+    std::array<int, MAX_CARS> m_origins;
+    std::array<std::vector<BitMask>, MAX_CARS> m_cells;
+};
+
+}
+
+GeneratorOptions::GeneratorOptions():
+    size(8),
+    carCount(6),
+    minMoves(1),
+    count(100),
+    threadCount(std::max(1u, std::thread::hardware_concurrency()))
+{
+
+}
+
+GenerationReport::GenerationReport():
+    trackSets(0),
+    layouts(0),
+    clusters(0),
+    seconds(0),
+    puzzles()
+{
+
+}
+
+GenerationReport generatePuzzles(const GeneratorOptions &options)
+{
+    if(options.size < 5 || options.size * options.size > static_cast<int>(sizeof(BitMask) * 8)){
+        throw std::runtime_error("The generated maps must be between 5x5 and 11x11, borders included");
+    }
+    if(options.carCount < 1 || options.carCount > MAX_CARS - 1){
+        throw std::runtime_error("The generated puzzles must have between 1 and " +
+                                 std::to_string(MAX_CARS - 1) + " cars");
+    }
+    auto start = std::chrono::steady_clock::now();
+    int exitRow = options.size / 2 - 1;
+    std::vector<Track> tracks = listTracks(options.size, exitRow);
+    std::vector<std::vector<uint8_t>> sets;
+    std::vector<int> room(2 * options.size, options.size - 2);
+    std::vector<uint8_t> current;
+    listTrackSets(tracks, 0, options.carCount - 1, room, current, sets);
+
+    std::vector<TrackSetResult> results(sets.size());
+    ThreadPool pool(std::max(1, options.threadCount));
+    pool.run(sets.size(), [&](size_t index, int){
+        std::vector<Track> cars(1, Track{false, exitRow, 2});
+        for(uint8_t track : sets[index]) cars.push_back(tracks[track]);
+        TrackSetSearch(options, cars, results[index]).run();
+    });
+
+    // The sets are gathered in their order, whichever thread solved them
+    GenerationReport report;
+    report.trackSets = sets.size();
+    for(TrackSetResult &result : results){
+        report.layouts += result.layouts;
+        report.clusters += result.clusters;
+        report.puzzles.insert(report.puzzles.end(), result.puzzles.begin(), result.puzzles.end());
+    }
+    std::stable_sort(report.puzzles.begin(), report.puzzles.end(), [](const GeneratedPuzzle &a, const GeneratedPuzzle &b){
+        return a.moves > b.moves;
+    });
+    if(report.puzzles.size() > options.count) report.puzzles.resize(options.count);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report.seconds = elapsed.count();
+    return report;
+}
+
+void writePuzzles(std::ostream &out, const std::vector<GeneratedPuzzle> &puzzles)
+{
+    for(size_t i = 0; i < puzzles.size(); ++i){
+        if(i) out << '\n';
+        out << puzzles[i].text;
+    }
+}
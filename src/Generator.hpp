@@ -0,0 +1,126 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstddef>
+
+/**
+ * @brief The GeneratorOptions struct which puzzles generatePuzzles looks for
+ */
+struct GeneratorOptions{
+
+    /**
+     * @brief GeneratorOptions constructor, for 6 cars on 6x6 maps (8x8 with
+     * the borders) on all the cores
+     */
+    GeneratorOptions();
+
+    /**
+     * @brief size the width and height of the maps, borders included
+     */
+    int size;
+
+    /**
+     * @brief carCount the number of cars of the puzzles, main car included
+     */
+    int carCount;
+
+    /**
+     * @brief minMoves the clusters whose hardest state needs fewer moves are left out
+     */
+    int minMoves;
+
+    /**
+     * @brief count the number of puzzles kept, the hardest ones
+     */
+    size_t count;
+
+    /**
+     * @brief threadCount the number of threads enumerating the clusters
+     */
+    int threadCount;
+};
+
+/**
+ * @brief The GeneratedPuzzle struct the hardest state of a cluster
+ */
+struct GeneratedPuzzle{
+
+    /**
+     * @brief moves the number of moves needed to solve the puzzle
+     */
+    int moves;
+
+    /**
+     * @brief clusterSize the number of states of its cluster
+     */
+    size_t clusterSize;
+
+    /**
+     * @brief text the puzzle, written as in the puzzle files
+     */
+    std::string text;
+};
+
+/**
+ * @brief The GenerationReport struct what generatePuzzles found
+ */
+struct GenerationReport{
+
+    /**
+     * @brief GenerationReport constructor, for an empty generation
+     */
+    GenerationReport();
+
+    /**
+     * @brief trackSets the number of sets of car tracks enumerated
+     */
+    size_t trackSets;
+
+    /**
+     * @brief layouts the number of placements of the cars enumerated
+     */
+    size_t layouts;
+
+    /**
+     * @brief clusters the number of clusters solved
+     */
+    size_t clusters;
+
+    /**
+     * @brief seconds the time spent
+     */
+    double seconds;
+
+    /**
+     * @brief puzzles the puzzles kept, hardest first
+     */
+    std::vector<GeneratedPuzzle> puzzles;
+};
+
+/**
+ * @brief generatePuzzles enumerates all the puzzles of a size and number of
+ * cars, and keeps the hardest ones. The main car lies on the exit row, the
+ * other cars are 2 or 3 cells long, on any other row or on any column.
+ * The cars are first chosen as sets of tracks (a row or column and a length),
+ * the sets being spread between the threads. Every placement of the cars
+ * of a set that isn't in a cluster already found starts a new cluster : its
+ * states are enumerated and solved backward from its solved states (see
+ * DistanceTable), and the cluster gives its hardest state. Two cars on the
+ * same track can't pass each other, so only one of their orders is enumerated.
+ * The puzzles are the same, in the same order, whatever the number of threads
+ * @param options the puzzles to look for
+ * @return the puzzles found and the work done
+ */
+GenerationReport generatePuzzles(const GeneratorOptions &options);
+
+/**
+ * @brief writePuzzles writes puzzles as a text pack, a blank line between them
+ * @param out the stream to write to
+ * @param puzzles the puzzles to write
+ */
+void writePuzzles(std::ostream &out, const std::vector<GeneratedPuzzle> &puzzles);
+
+#endif // GENERATOR_HPP
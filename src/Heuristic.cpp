@@ -0,0 +1,118 @@
+#include "Heuristic.hpp"
+#include "Map.hpp"
+#include "State.hpp"
+
+#include <array>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief cellOn coordinates of a cell on the line a car moves on
+ * @param data the car
+ * @param position the position on the line (the x value for a horizontal car,
+ * the y value for a vertical car)
+ * @return the coordinates of the cell
+ */
+Point cellOn(const MapCar &data, int position)
+{
+    if(data.orientation == Orientation::VERTICAL){
+        return Point(data.axisValue, position);
+    } else {
+        return Point(position, data.axisValue);
+    }
+}
+
+/**
+ * @brief carsOn lists the cars standing on some cells of the line of a car
+ * @param map the map with the state placed on it
+ * @param data the car giving the line
+ * @param from the first position to check
+ * @param to the last position to check (included)
+ * @param cars the cars found, one bit per car code
+ * @return false if a wall (or the exit) is on the cells, meaning that the
+ * car can never go through them
+ */
+bool carsOn(const Map &map, const MapCar &data, int from, int to, uint32_t &cars)
+{
+    for(int p = from; p <= to; ++p){
+        char value = map.at(cellOn(data, p));
+        if(value == ' ') continue;
+        if(value < 0 || value >= MAX_CARS) return false;
+        cars |= 1u << value;
+    }
+    return true;
+}
+
+/**
+ * @brief cheapestUnion finds the smallest set of cars that must move, when
+ * each blocking car chooses one of its ways out
+ * @param options the cars in the way of each side, for each blocking car
+ * @param optionCount the number of sides available for each blocking car
+ * @param blockerCount the number of blocking cars
+ * @param index the blocking car to choose the side of
+ * @param cars the cars that must move with the sides already chosen
+ * @return the minimum number of cars that must move
+ */
+int cheapestUnion(const std::array<std::array<uint32_t, 2>, MAX_CARS> &options,
+                  const std::array<int, MAX_CARS> &optionCount,
+                  int blockerCount, int index, uint32_t cars)
+{
+    if(index == blockerCount) return __builtin_popcount(cars);
+    int best = UNSOLVABLE;
+    for(int o = 0; o < optionCount[index]; ++o){
+        best = std::min(best, cheapestUnion(options, optionCount, blockerCount, index + 1,
+                                            cars | options[index][o]));
+    }
+    return best;
+}
+
+}
+
+int estimateMoves(Map &map, const State &state, Heuristic heuristic)
+{
+    if(state.isSolutionOf(map)) return 0;
+    map.placeState(state);
+
+    const StateCar &mainCar = state.car(0);
+    const MapCar &mainData = map.getCarData(mainCar.code);
+    const Point &out = map.exit();
+    int exitPosition = mainData.orientation == Orientation::VERTICAL ? out.y : out.x;
+
+    uint32_t blockers = 0;
+    bool free = exitPosition > mainCar.origin ?
+                carsOn(map, mainData, mainCar.origin + mainData.length, exitPosition - 1, blockers) :
+                carsOn(map, mainData, exitPosition + 1, mainCar.origin - 1, blockers);
+    if(!free) return UNSOLVABLE;
+    if(heuristic == BLOCKING_CARS) return 1 + __builtin_popcount(blockers);
+
+    std::array<int8, MAX_CARS> origins;
+    for(int i = 0; i < state.carCount(); ++i) origins[state.car(i).code] = state.car(i).origin;
+
+    // For every blocking car, the cars standing where it must
+    // go to leave the main car's line, above/left or below/right
+    std::array<std::array<uint32_t, 2>, MAX_CARS> options;
+    std::array<int, MAX_CARS> optionCount;
+    int blockerCount = 0;
+    for(int8 code = 0; code < MAX_CARS; ++code){
+        if(!(blockers & (1u << code))) continue;
+        const MapCar &data = map.getCarData(code);
+        if(data.orientation == mainData.orientation) return UNSOLVABLE;
+
+        int origin = origins[code];
+        int cross = mainData.axisValue;
+        int lastPosition = (data.orientation == Orientation::VERTICAL ? map.height() : map.width()) - 2;
+        int count = 0;
+        uint32_t cars = 0;
+        if(cross - data.length >= 1 && carsOn(map, data, cross - data.length, origin - 1, cars)){
+            options[blockerCount][count++] = cars;
+        }
+        cars = 0;
+        if(cross + data.length <= lastPosition && carsOn(map, data, origin + data.length, cross + data.length, cars)){
+            options[blockerCount][count++] = cars;
+        }
+        if(count == 0) return UNSOLVABLE;
+        optionCount[blockerCount++] = count;
+    }
+    return 1 + cheapestUnion(options, optionCount, blockerCount, 0, blockers);
+}
@@ -0,0 +1,43 @@
+#ifndef HEURISTIC_HPP
+#define HEURISTIC_HPP
+
+class Map;
+class State;
+
+/**
+ * @brief The Heuristic enum the lower bounds of the number
+ * of moves needed to solve a state
+ */
+enum Heuristic {
+    /**
+     * @brief BLOCKING_CARS the main car must move, and every car
+     * between the main car and the exit must move at least once
+     */
+    BLOCKING_CARS,
+    /**
+     * @brief BLOCKERS_OF_BLOCKERS as BLOCKING_CARS, but also counts
+     * the cars standing where the blocking cars must go to free
+     * the way, choosing the cheapest side for every blocking car
+     */
+    BLOCKERS_OF_BLOCKERS
+};
+
+/**
+ * @brief UNSOLVABLE value returned when a state can never be solved
+ * (a wall, or a car parallel to the main car, between the main car and the exit)
+ */
+const int UNSOLVABLE = 1 << 16;
+
+/**
+ * @brief estimateMoves admissible estimation of the number of moves
+ * needed to solve the given state : it is never more than the real number
+ * of moves, since every car counted has to move at least once
+ * @param map the map of the state, the state is placed on it
+ * @param state the state to estimate
+ * @param heuristic the lower bound to use
+ * @return the minimum number of moves to solve the state, UNSOLVABLE if
+ * the state has no solution
+ */
+int estimateMoves(Map &map, const State &state, Heuristic heuristic);
+
+#endif // HEURISTIC_HPP
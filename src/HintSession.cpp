@@ -0,0 +1,288 @@
+#include "HintSession.hpp"
+#include "Search.hpp"
+#include "FixedSearch.hpp"
+#include "SearchTree.hpp"
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief MAX_REPLAY_MOVES number of moves after which replayHints stops a game
+ */
+const int MAX_REPLAY_MOVES = 200;
+
+/**
+ * @brief searchDistance solves a position with breadthFirstSearch
+ * @param board the map without its cars
+ * @param position the position to solve
+ * @param seconds the time spent, increased by the search
+ * @return the number of moves left, -1 if the position can't be solved
+ */
+int searchDistance(const Map &board, const State &position, double &seconds)
+{
+    Map map = board;
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result = breadthFirstSearch(map, position);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    seconds += elapsed.count();
+    return result.found ? result.moves() : -1;
+}
+
+}
+
+HintReplay::HintReplay():
+    positions(0),
+    lookups(0),
+    mismatches(0),
+    hintSeconds(0),
+    searchSeconds(0)
+{
+
+}
+
+Hint::Hint():
+    found(false),
+    distance(-1),
+    move(),
+    lookup(false),
+    explored(0)
+{
+
+}
+
+HintSession::HintSession(const Map &map, Heuristic heuristic):
+    m_board(map),
+    m_start(),
+    m_heuristic(heuristic),
+    m_distances(),
+    m_firstDepths(),
+    m_firstDistance(-1)
+{
+    m_start.extractFrom(m_board);
+}
+
+const State &HintSession::start() const
+{
+    return m_start;
+}
+
+Map &HintSession::board()
+{
+    return m_board;
+}
+
+size_t HintSession::knownCount() const
+{
+    return m_distances.size();
+}
+
+Hint HintSession::hint(const State &position)
+{
+    Hint hint;
+    if(lookup(position, hint)) return hint;
+    hint = Hint();
+    if(!m_firstDepths.size()) firstSearch(position, hint);
+    else localSearch(position, hint);
+    return hint;
+}
+
+bool HintSession::lookup(const State &position, Hint &hint)
+{
+    const int *known = m_distances.find(position.key(m_board.encoder()));
+    if(!known) return false;
+    int distance = *known;
+    hint.lookup = true;
+    hint.found = distance >= 0;
+    hint.distance = std::max(distance, -1);
+    if(distance <= 0) return true;
+
+    // A known state always has a known neighbour one move closer,
+    // the next state of the solution it was learned from
+    std::vector<Move> moves;
+    position.moves(m_board, moves);
+    for(const Move &move : moves){
+        State next = position;
+        next.play(move);
+        const int *nextDistance = m_distances.find(next.key(m_board.encoder()));
+        if(nextDistance && *nextDistance == distance - 1){
+            hint.move = move;
+            return true;
+        }
+    }
+    return false;
+}
+
+void HintSession::firstSearch(const State &position, Hint &hint)
+{
+    SearchTree tree;
+    SearchResult result = specializedBreadthFirstSearch(m_board, position, tree);
+    hint.explored = result.explored;
+
+    // The parent of a node comes before it, and its depth is the shortest one
+    std::vector<int> depths(tree.size());
+    for(size_t i = 0; i < tree.size(); ++i){
+        int32_t parent = tree.parent(i);
+        depths[i] = parent == SearchTree::NO_PARENT ? 0 : depths[parent] + 1;
+        m_firstDepths.insert(tree.key(i), depths[i]);
+    }
+    if(!result.found){
+        // The search went through the whole cluster of the position
+        for(size_t i = 0; i < tree.size(); ++i) m_distances.insert(tree.key(i), -1);
+        return;
+    }
+    m_firstDistance = result.moves();
+    learn(result.path, m_firstDistance);
+    hint.found = true;
+    hint.distance = m_firstDistance;
+    if(result.path.size() > 1) hint.move = position.moveTo(result.path[1]);
+}
+
+void HintSession::localSearch(const State &position, Hint &hint)
+{
+    const StateEncoder &encoder = m_board.encoder();
+    std::vector<State> states(1, position);
+    std::vector<int> anc(1, -1);
+    std::vector<int> depths(1, 0);
+    StateMap<int> best;
+    best.insert(position.key(encoder), 0);
+
+    int startEstimate = estimate(position);
+    if(startEstimate >= UNSOLVABLE){
+        m_distances.insert(position.key(encoder), -1);
+        return;
+    }
+
+    // The length of the best path found, and its last state : a solved one or a known one
+    int bound = UNSOLVABLE;
+    int end = -1;
+    if(position.isSolutionOf(m_board)){
+        bound = 0;
+        end = 0;
+    }
+
+    std::vector<std::vector<int>> buckets(startEstimate + 1);
+    if(startEstimate < bound) buckets[startEstimate].push_back(0);
+    std::vector<State> successors;
+    for(size_t f = startEstimate; f < buckets.size() && static_cast<int>(f) < bound; ++f){
+        while(!buckets[f].empty()){
+            int index = buckets[f].back();
+            buckets[f].pop_back();
+            State current = states[index];
+            if(*best.find(current.key(encoder)) != index) continue;
+            hint.explored++;
+
+            successors.clear();
+            current.successors(m_board, successors);
+            int depth = depths[index] + 1;
+            for(const State &next : successors){
+                StateKey key = next.key(encoder);
+                int *reached = best.find(key);
+                if(reached && depths[*reached] <= depth) continue;
+
+                // The states whose moves left are known end the path
+                const int *known = m_distances.find(key);
+                int left = known ? *known : next.isSolutionOf(m_board) ? 0 : -1;
+                if(known && left < 0) continue;
+                int nextEstimate = left >= 0 ? left : estimate(next);
+                if(nextEstimate >= UNSOLVABLE || depth + nextEstimate >= bound) continue;
+
+                int nextIndex = static_cast<int>(states.size());
+                states.push_back(next);
+                anc.push_back(index);
+                depths.push_back(depth);
+                if(reached) *reached = nextIndex;
+                else best.insert(key, nextIndex);
+
+                if(left >= 0){
+                    bound = depth + left;
+                    end = nextIndex;
+                    continue;
+                }
+                size_t bucket = depth + nextEstimate;
+                if(bucket >= buckets.size()) buckets.resize(bucket + 1);
+                buckets[bucket].push_back(nextIndex);
+            }
+        }
+    }
+
+    if(end < 0){
+        // Nothing was pruned but the states without solution
+        for(const State &state : states) m_distances.insert(state.key(encoder), -1);
+        return;
+    }
+    std::vector<State> path;
+    for(int i = end; i >= 0; i = anc[i]) path.push_back(states[i]);
+    std::reverse(path.begin(), path.end());
+    learn(path, bound);
+    hint.found = true;
+    hint.distance = bound;
+    if(path.size() > 1) hint.move = position.moveTo(path[1]);
+}
+
+int HintSession::estimate(const State &state)
+{
+    int moves = estimateMoves(m_board, state, m_heuristic);
+    if(moves >= UNSOLVABLE || m_firstDistance < 0) return moves;
+    const int *depth = m_firstDepths.find(state.key(m_board.encoder()));
+    return depth ? std::max(moves, m_firstDistance - *depth) : moves;
+}
+
+void HintSession::learn(const std::vector<State> &path, int distance)
+{
+    const StateEncoder &encoder = m_board.encoder();
+    for(size_t i = 0; i < path.size(); ++i){
+        m_distances.insert(path[i].key(encoder), distance - static_cast<int>(i));
+    }
+}
+
+HintReplay replayHints(const Map &map, int games, unsigned seed, Heuristic heuristic)
+{
+    HintReplay replay;
+    for(int game = 0; game < games; ++game){
+        HintSession session(map, heuristic);
+        std::mt19937 random(seed + game);
+        State position = session.start();
+        std::vector<Move> moves;
+        // The distance the last hint promised for this position, -2 when none
+        int promised = -2;
+        for(int played = 0; played <= MAX_REPLAY_MOVES; ++played){
+            auto start = std::chrono::steady_clock::now();
+            Hint hint = session.hint(position);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            replay.hintSeconds += elapsed.count();
+            replay.positions++;
+            if(hint.lookup) replay.lookups++;
+
+            int distance = searchDistance(session.board(), position, replay.searchSeconds);
+            moves.clear();
+            position.moves(session.board(), moves);
+            bool legal = std::any_of(moves.begin(), moves.end(), [&hint](const Move &move){
+                return move.car == hint.move.car && move.distance == hint.move.distance;
+            });
+            bool agrees = hint.found == (distance >= 0) && hint.distance == distance &&
+                    (distance <= 0 || legal) && (promised == -2 || promised == distance);
+            if(!agrees) replay.mismatches++;
+            if(distance <= 0 || moves.empty()) break;
+
+            // The hinted move is checked on the next position when it is played,
+            // and with its own search when a random move is played instead
+            if(!legal || random() % 3 == 0){
+                if(legal){
+                    State next = position;
+                    next.play(hint.move);
+                    if(searchDistance(session.board(), next, replay.searchSeconds) != distance - 1) replay.mismatches++;
+                }
+                position.play(moves[random() % moves.size()]);
+                promised = -2;
+            } else {
+                position.play(hint.move);
+                promised = distance - 1;
+            }
+        }
+    }
+    return replay;
+}
@@ -0,0 +1,222 @@
+#ifndef HINTSESSION_HPP
+#define HINTSESSION_HPP
+
+#include <cstddef>
+#include "Map.hpp"
+#include "State.hpp"
+#include "StateMap.hpp"
+#include "Heuristic.hpp"
+
+/**
+ * @brief The Hint struct the answer to a position
+ */
+struct Hint{
+
+    /**
+     * @brief Hint constructor, for a position without solution
+     */
+    Hint();
+
+    /**
+     * @brief found wether the position can be solved
+     */
+    bool found;
+
+    /**
+     * @brief distance the number of moves left, -1 if the position can't be solved
+     */
+    int distance;
+
+    /**
+     * @brief move a move leading one step closer to the solution,
+     * of distance 0 when the position is solved or can't be
+     */
+    Move move;
+
+    /**
+     * @brief lookup wether the hint was read from the distances already
+     * known, without searching
+     */
+    bool lookup;
+
+    /**
+     * @brief explored number of states expanded to answer
+     */
+    size_t explored;
+};
+
+/**
+ * @brief The HintSession class answers the positions of a game one after the
+ * other, keeping what the previous answers found.
+ * The first position is solved with the breadth-first search, which gives the
+ * depth of every state it reached from that position, and the exact number of
+ * moves left for the states of the solution. Any later position on a solution
+ * already found is answered with a lookup. Otherwise (the player left the best
+ * moves), an A* search runs from the position, where a state whose number of
+ * moves left is known ends the path : the search stops as soon as no state
+ * left can beat the best path found. Its estimation is the heuristic, raised
+ * by the first search : a state at depth g from the first position P is at
+ * least distance(P) - g moves away from the solution, so the states around
+ * the solution already found are estimated well and the search stays local.
+ * Every solution found is remembered for the next positions
+ */
+class HintSession
+{
+public:
+    /**
+     * @brief HintSession constructor, throws an exception if
+     * the cars of the map can't be handled
+     * @param map the map of the game, with its cars, as parseFile reads it
+     * @param heuristic the lower bound used by the searches after the first one
+     */
+    explicit HintSession(const Map &map, Heuristic heuristic = BLOCKERS_OF_BLOCKERS);
+
+    /**
+     * @brief start the starting position of the map
+     * @return the position
+     */
+    const State &start() const;
+
+    /**
+     * @brief board the map without its cars, to place the positions on
+     * @return the board
+     */
+    Map &board();
+
+    /**
+     * @brief hint finds the best move of a position of the game
+     * @param position a position of the map, reached by moves or not
+     * @return the hint
+     */
+    Hint hint(const State &position);
+
+    /**
+     * @brief knownCount number of states whose number of moves left is known
+     * @return the number of states
+     */
+    size_t knownCount() const;
+
+private:
+    /**
+     * @brief lookup answers a position whose number of moves left is known
+     * @param position the position
+     * @param hint the hint to fill
+     * @return false if the position is not known
+     */
+    bool lookup(const State &position, Hint &hint);
+
+    /**
+     * @brief firstSearch solves the first position with the breadth-first search,
+     * and keeps the depth of all the states it reached
+     * @param position the position
+     * @param hint the hint to fill
+     */
+    void firstSearch(const State &position, Hint &hint);
+
+    /**
+     * @brief localSearch solves a position with the A* search
+     * stopped by the states already known
+     * @param position the position
+     * @param hint the hint to fill
+     */
+    void localSearch(const State &position, Hint &hint);
+
+    /**
+     * @brief estimate the lower bound of the moves left of a state
+     * @param state the state
+     * @return the number of moves, UNSOLVABLE if the state has no solution
+     */
+    int estimate(const State &state);
+
+    /**
+     * @brief learn remembers the number of moves left of the states of a solution
+     * @param path the states of the solution, the last one being solved or known
+     * @param distance the number of moves left of the first state
+     */
+    void learn(const std::vector<State> &path, int distance);
+
+    /**
+     * @brief m_board the map, the states are placed on it
+     */
+    Map m_board;
+
+    /**
+     * @brief m_start the starting position of the map
+     */
+    State m_start;
+
+    /**
+     * @brief m_heuristic the lower bound of the A* searches
+     */
+    Heuristic m_heuristic;
+
+    /**
+     * @brief m_distances the number of moves left of the states known,
+     * -1 for the states without solution
+     */
+    StateMap<int> m_distances;
+
+    /**
+     * @brief m_firstDepths the depth of the states reached by the first search
+     */
+    StateMap<int> m_firstDepths;
+
+    /**
+     * @brief m_firstDistance the number of moves left of the first position,
+     * -1 before the first search
+     */
+    int m_firstDistance;
+};
+
+/**
+ * @brief The HintReplay struct what replayHints checked
+ */
+struct HintReplay{
+
+    /**
+     * @brief HintReplay constructor, for no game played
+     */
+    HintReplay();
+
+    /**
+     * @brief positions number of positions answered
+     */
+    size_t positions;
+
+    /**
+     * @brief lookups number of positions answered with a lookup
+     */
+    size_t lookups;
+
+    /**
+     * @brief mismatches number of hints disagreeing with breadthFirstSearch
+     */
+    size_t mismatches;
+
+    /**
+     * @brief hintSeconds time spent answering the positions
+     */
+    double hintSeconds;
+
+    /**
+     * @brief searchSeconds time spent by breadthFirstSearch on the same positions
+     */
+    double searchSeconds;
+};
+
+/**
+ * @brief replayHints plays games on a map, asking a HintSession for every
+ * position, and checks every hint against breadthFirstSearch from that
+ * position : the same number of moves left, and a legal move leading to a
+ * position one move closer. The player follows the hints, but plays a random
+ * move a third of the time, so that both the lookups and the local searches
+ * are checked. A game stops once solved, or after MAX_REPLAY_MOVES moves
+ * @param map the map of the game, with its cars, as parseFile reads it
+ * @param games number of games to play, each one with its own session
+ * @param seed the seed of the random moves of the first game, the next games using the next seeds
+ * @param heuristic the lower bound used by the sessions
+ * @return what was checked
+ */
+HintReplay replayHints(const Map &map, int games, unsigned seed, Heuristic heuristic = BLOCKERS_OF_BLOCKERS);
+
+#endif // HINTSESSION_HPP
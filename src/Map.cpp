@@ -5,8 +5,12 @@
 
 #include "Map.hpp"
 #include "Car.hpp"
+#include "SearchStats.hpp"
 #include <sstream>
+#include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 bool isStaticValue(char data)
 {
@@ -24,8 +28,19 @@ Map::Map(){}
 Map::Map(int width, int height):
 m_map(height),
 m_emptyMap(height),
+m_walls(width, height),
+m_board(width, height),
+m_placed(),
 m_width(width),
 m_height(height){
+    if(width * height > static_cast<int>(sizeof(BitMask) * 8)){
+        throw std::runtime_error("The map is too big, it can't have more than " +
+                                 std::to_string(sizeof(BitMask) * 8) + " cells");
+    }
+    if(width > MAX_LINE || height > MAX_LINE){
+        throw std::runtime_error("The map is too big, its rows and columns can't have more than " +
+                                 std::to_string(MAX_LINE) + " cells");
+    }
     for(auto &v: m_map)v.resize(m_width, ' ');
     for(auto &v: m_emptyMap)v.resize(m_width, ' ');
 }
@@ -46,6 +61,10 @@ void Map::setValue(int x, int y, char value)
     if(isStaticValue(value)){
         m_map[y][x] = value;
         m_emptyMap[y][x] = value;
+        if(value != ' ') {
+            m_walls.setOccupied(x, y);
+            m_board.setOccupied(x, y);
+        }
         if(value == 'z')  m_wayOut = Point(x, y);
     }else {
         m_map[y][x] = value - 'a';
@@ -57,9 +76,9 @@ const Point& Map::exit() const
     return m_wayOut;
 }
 
-const MapCar &Map::getCarData(int8 code) const
+const Bitboard &Map::walls() const
 {
-    return m_cars.find(code)->second;
+    return m_walls;
 }
 
 char Map::at(int x, int y) const
@@ -73,75 +92,84 @@ char Map::at(const Point &p) const
     return at(p.x, p.y);
 }
 
-void Map::setCarValue(int x, int y, int8 value)
+void Map::paintCar(const StateCar &car, int8 value)
 {
-    int8& val = m_map[y][x];
+    const MapCar &carData = getCarData(car.code);
+    if(value == ' '){
+        m_board.removeCar(track(car.code), car.origin);
+    } else {
+        m_board.addCar(track(car.code), car.origin);
+    }
 
-    if(val != ' '){
-        // Error cell not empty
-        throw std::runtime_error(
-                    "The impossible happened, two cars collided, on x = " + std::to_string(x) + ", y = "  + std::to_string(y) +
-                    "\nExisting value = " + toReadable(val) + " - trying to add " + toReadable(value));
-    } else{
-        val = value;
+    if(carData.orientation == Orientation::VERTICAL){
+        for(int y = car.origin; y < car.origin + carData.length; ++y){
+            m_map[y][carData.axisValue] = value;
+        }
+    } else {
+        std::fill_n(m_map[carData.axisValue].begin() + car.origin, carData.length, value);
     }
 }
 
-void Map::addCar(const StateCar &car)
+void Map::placeState(const State &state)
 {
-    MapCar carData = getCarData(car.code);
-    Point start = carData.originEnd(car);
-    Point end = carData.otherEnd(car);
-
-    if(carData.orientation == Orientation::VERTICAL){
-        for(int y = start.y; y < end.y; ++y){
-            setCarValue(carData.axisValue, y, car.code);
+    RUSHHOUR_STATS_PHASE(BOARD_PAINTING);
+    // Remove first all the cars that moved, so that a car
+    // never overwrites another one that still has to leave
+    for(int i = 0; i < state.carCount(); ++i){
+        const StateCar &car = state.car(i);
+        int8 placed = m_placed[car.code];
+        if(placed && placed != car.origin){
+            paintCar(StateCar(car.code, placed), ' ');
+            m_placed[car.code] = 0;
         }
-    } else {
-        for(int x = start.x; x < end.x; ++x){
-            setCarValue(x, carData.axisValue, car.code);
+    }
+    for(int i = 0; i < state.carCount(); ++i){
+        const StateCar &car = state.car(i);
+        if(!m_placed[car.code]){
+            paintCar(car, car.code);
+            m_placed[car.code] = car.origin;
         }
     }
 }
 
+void Map::moveCar(const StateCar &car, int distance)
+{
+    RUSHHOUR_STATS_PHASE(BOARD_PAINTING);
+    paintCar(car, ' ');
+    StateCar moved(car.code, car.origin + distance);
+    paintCar(moved, car.code);
+    m_placed[car.code] = moved.origin;
+}
+
+void Map::undoMove(const StateCar &car, int distance)
+{
+    moveCar(StateCar(car.code, car.origin + distance), -distance);
+}
+
+const Bitboard &Map::board() const
+{
+    return m_board;
+}
+
 void Map::reset()
 {
-    m_map = std::vector<std::vector<int8>>();
-    for(const auto& vec : m_emptyMap) {
-        m_map.push_back(vec);
+    for(size_t y = 0; y < m_map.size(); ++y){
+        std::copy(m_emptyMap[y].begin(), m_emptyMap[y].end(), m_map[y].begin());
     }
+    m_board = m_walls;
+    m_placed.fill(0);
 }
 
 bool Map::canMoveCar(const StateCar &car, int direction) const
 {
-    const MapCar &mCar = getCarData(car.code);
-    int incr = 0;
-    if(direction < 0){
-        do{
-            incr--;
-            if(at(mCar.originEnd(car, -incr)) != ' '){
-                return false;// Other car already here
-            }
-        }while(incr != direction);
-    } else{
-        do{
-            if(at(mCar.otherEnd(car, incr)) != ' '){
-                return false;// Other car already here
-            }
-            incr++;
-        }while(incr != direction);
-    }
-    return true;
+    const CarTrack &carTrack = track(car.code);
+    if(direction < 0) return -direction <= m_board.freeBefore(carTrack, car.origin);
+    return direction <= m_board.freeAfter(carTrack, car.origin);
 }
 
 int Map::distanceAfter(const StateCar &car) const
 {
-    MapCar carData = getCarData(car.code);
-    if(carData.orientation == Orientation::VERTICAL){
-        return m_width - car.origin - carData.length - 1;
-    } else {
-        return m_height - car.origin - carData.length - 1;
-    }
+    return track(car.code).lastOrigin - car.origin;
 }
 
 StateCar Map::getCar(const int x, const int y)
@@ -169,11 +197,40 @@ StateCar Map::getCar(const int x, const int y)
         // Error, cars of length one do not exist
         throw std::runtime_error("Can't process cars with length 1");
     }
-    // Be able to encode the car code with only 4 bits
+    // The axis of the car and its origin along its line
     Point carData = carOrientation == Orientation::VERTICAL ? Point(x, y) : Point(y, x);
+    return addCar(code, carLength, carOrientation, carData.x, carData.y);
+}
 
-    m_cars[code] = MapCar(code, carLength, carOrientation, carData.x);
-    return StateCar(code, carData.y);
+StateCar Map::addCar(int8 code, int8 length, Orientation orientation, int8 axisValue, int8 origin)
+{
+    if(code < 0 || code >= MAX_CARS){
+        throw std::runtime_error("Car codes go from 'a' to '" + std::string(1, toReadable(MAX_CARS - 1)) + "'");
+    }
+    if(length < 2) throw std::runtime_error("Can't process cars with length 1");
+    m_cars[code] = MapCar(code, length, orientation, axisValue);
+    m_tracks[code] = CarTrack(m_cars[code], m_width, m_height);
+    // The origins are 1-based, so the last one is also the number of origins of the car
+    const int originCount = m_tracks[code].lastOrigin;
+    if(originCount < 1 || origin < 1 || origin > originCount){
+        throw std::runtime_error("The car " + std::string(1, toReadable(code)) + " overlaps the border of the map");
+    }
+    m_encoder.addCar(code, originCount);
+    return StateCar(code, origin);
+}
+
+uint64_t Map::fingerprint() const
+{
+    uint64_t hash = hashKey(StateKey(m_width) << 8 | m_height);
+    for(const auto &row : m_emptyMap){
+        for(int8 value : row) hash = hashKey((StateKey(hash) << 8) | static_cast<uint8_t>(value));
+    }
+    for(const MapCar &car : m_cars){
+        if(!car.length) continue;
+        hash = hashKey((StateKey(hash) << 32) | (StateKey(car.code) << 24) | (car.length << 16) |
+                       (car.orientation << 8) | car.axisValue);
+    }
+    return hash;
 }
 
 std::string Map::toString() const
@@ -193,3 +250,46 @@ bool Map::isValid(int x, int y) const
 {
     return x >= 0 && y >= 0 && x < m_width && y < m_height;
 }
+
+Map parseFile(const std::string &mapName)
+{
+    std::ifstream mapF;
+    mapF.open(mapName);
+    if(!mapF.is_open()) throw std::runtime_error("Can't open the puzzle " + mapName);
+    return parseMap(mapF, mapName);
+}
+
+Map parseMap(std::istream &mapF, const std::string &mapName)
+{
+    int width = 0;
+    int height = 0;
+    char comma = 0;
+    mapF >> height >> comma >> width;
+    if(!mapF || comma != ',' || width <= 0 || height <= 0){
+        throw std::runtime_error("The first line of " + mapName + " must be the size of the map");
+    }
+
+    std::string input;
+    std::getline(mapF, input);// end of the first line
+
+    Map mMap(width, height);
+    for(int y = 0; y < height; ++y){//read all columns
+        // The rows end with "\n" or "\r\n", the last one is not read past
+        // its width, so that a map read from a socket is complete at its last cell
+        input.clear();
+        int c = 0;
+        while(static_cast<int>(input.size()) < width && (c = mapF.get()) != EOF && c != '\r' && c != '\n'){
+            input += static_cast<char>(c);
+        }
+        if(static_cast<int>(input.size()) < width){
+            throw std::runtime_error("The row " + std::to_string(y + 1) + " of " + mapName + " is too short");
+        }
+        if(y + 1 < height) mapF.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        for(int x = 0; x < width; ++x){// read all lines
+            mMap.setValue(x, y, input[x]);
+        }
+    }
+
+    // Map detect objects
+    return mMap;
+}
@@ -8,7 +8,11 @@
 #include <vector>
 #include <queue>
 #include <string>
+#include <istream>
+#include <array>
 #include "Car.hpp"
+#include "Bitboard.hpp"
+#include "StateEncoder.hpp"
 #include "State.hpp"
 
 /**
@@ -49,6 +53,8 @@ public:
     /**
      * @brief Map constructor with the width and height,
      * to initiliaze the space of the grid
+     * throws an exception if the map has more cells
+     * than a bitboard can hold, or lines longer than MAX_LINE
      * @param width width of the map
      * @param height height of the map
      */
@@ -93,13 +99,45 @@ public:
      */
     const Point  &exit() const;
 
+    /**
+     * @brief walls accessor for the occupancy of the empty map
+     * (borders, exit and inner walls), the cars are then added
+     * on a copy of this board to compute their moves
+     * @return the bitboard of the map without any car
+     */
+    const Bitboard &walls() const;
+
     /**
      * @brief getCarData finds the MapCar corresponding
      * to the given code
      * @param code the code of the car to search for
      * @return the mapCar that has the given code
      */
-    const MapCar &getCarData(int8 code) const;
+    const MapCar &getCarData(int8 code) const
+    {
+        return m_cars[code];
+    }
+
+    /**
+     * @brief track the precomputed tables of the car with the
+     * given code, to paint it and find its moves on the bitboard
+     * @param code the code of the car
+     * @return the tables of the car
+     */
+    const CarTrack &track(int8 code) const
+    {
+        return m_tracks[code];
+    }
+
+    /**
+     * @brief encoder the layout of the packed states of this map,
+     * complete once all the cars were found
+     * @return the encoder of the states
+     */
+    const StateEncoder &encoder() const
+    {
+        return m_encoder;
+    }
 
     /**
      * @brief canMoveCar on of the main function of this solver
@@ -127,12 +165,45 @@ public:
     int distanceAfter(const StateCar & car) const;
 
     /**
-     * @brief addCar changes the map to add the given car
-     * can throw an exception if a car is already positioned where
-     * the new car is placed
-     * @param car the car to place
+     * @brief placeState puts the cars of the given state on the map
+     * only the cars that are not already at the right place are moved,
+     * so walking from a state to a close one only costs the few cells
+     * that changed
+     * @param state the state to put on the map
+     */
+    void placeState(const State &state);
+
+    /**
+     * @brief moveCar slides a car already on the map,
+     * the move must be valid (the cells on the way must be empty)
+     * only the cells of the car are updated, without any check
+     * @param car the car, at its position before the move
+     * @param distance the distance to move (negative to move left or up)
      */
-    void addCar(const StateCar &car);
+    void moveCar(const StateCar &car, int distance);
+
+    /**
+     * @brief undoMove reverts a move done with moveCar
+     * @param car the car, at its position before the move
+     * @param distance the distance given to moveCar
+     */
+    void undoMove(const StateCar &car, int distance);
+
+    /**
+     * @brief board accessor for the live occupancy of the map,
+     * walls and the cars currently placed
+     * @return the bitboard of the map with its cars
+     */
+    const Bitboard &board() const;
+
+    /**
+     * @brief fingerprint hash of everything that never changes during
+     * the game : the walls, the exit and the metadata of the cars,
+     * two maps with the same fingerprint give the same meaning to
+     * the packed states
+     * @return the hash of the map
+     */
+    uint64_t fingerprint() const;
 
     /**
      * @brief toString string version of the map
@@ -152,10 +223,9 @@ public:
     void setValue(int x, int y, char value);
 
     /**
-     * @brief reset removes all the boxes
-     * and the player of the map,
-     * only the target, the empty places
-     * and the target are left afterward
+     * @brief reset removes all the cars of the map,
+     * only the walls, the empty places
+     * and the exit are left afterward
      */
     void reset();
 
@@ -184,16 +254,28 @@ public:
      */
     StateCar getCar(const int x,  const int y);
 
+    /**
+     * @brief addCar stores the MapCar of a car whose cells are known,
+     * without painting it, as getCar does once it found the car.
+     * Throws an exception if the code is unknown, the car is shorter
+     * than 2 cells or it overlaps the border of the map
+     * @param code the code of the car
+     * @param length the number of cells of the car
+     * @param orientation the direction the car slides in
+     * @param axisValue the row of a horizontal car, the column of a vertical one
+     * @param origin the column of the first cell of a horizontal car, the row of a vertical one
+     * @return the StateCar of the car
+     */
+    StateCar addCar(int8 code, int8 length, Orientation orientation, int8 axisValue, int8 origin);
+
 private:
     /**
-     * @brief setCarValue used when adding a car on the map
-     * checks if the spot is empty and throws an exception
-     * if it's no
-     * @param x the x coordinate to search for
-     * @param y the y coordinate to search for
-     * @param value the value to set
+     * @brief paintCar writes the car on the grid and the bitboard
+     * @param car the car to paint
+     * @param value the value of the cells, the car's code to add it,
+     * space to remove it
      */
-    void setCarValue(int x, int y, int8 value);
+    void paintCar(const StateCar &car, int8 value);
 
     /**
      * @brief m_map the map itself
@@ -207,12 +289,41 @@ private:
      */
     std::vector<std::vector<int8>> m_emptyMap;
 
+    /**
+     * @brief m_walls bitboard version of the empty map
+     */
+    Bitboard m_walls;
+
+    /**
+     * @brief m_board bitboard version of the map, with its cars
+     */
+    Bitboard m_board;
+
+    /**
+     * @brief m_placed the origin of each car currently
+     * on the map, indexed by the car's code, 0 when
+     * the car is not on the map
+     */
+    std::array<int8, MAX_CARS> m_placed;
+
     /**
      * @brief m_cars quick access to the map's
-     * cars, the key is the car's code, and the
-     * value is the MapCar
+     * cars, indexed by the car's code, a car
+     * of length 0 is not on the map
      */
-    std::unordered_map<int8, MapCar> m_cars;
+    std::array<MapCar, MAX_CARS> m_cars;
+
+    /**
+     * @brief m_tracks the precomputed moves of
+     * the map's cars, indexed by the car's code
+     */
+    std::array<CarTrack, MAX_CARS> m_tracks;
+
+    /**
+     * @brief m_encoder the layout of the packed states,
+     * a field is added for every car found
+     */
+    StateEncoder m_encoder;
 
     /**
      * @brief m_wayOut the map's exit position
@@ -230,5 +341,24 @@ private:
     int m_height;
 };
 
+/**
+ * @brief parseFile reads a map file : the first line gives
+ * the size of the map, then every line gives a row of the map,
+ * the lines can end with "\n" or "\r\n", throws an exception if the
+ * file can't be opened or is not a map
+ * @param mapName the path of the file
+ * @return the map read
+ */
+Map parseFile(const std::string &mapName);
+
+/**
+ * @brief parseMap reads a map as parseFile, from a stream, the
+ * stream is left after the last cell of the map, so that several
+ * maps can be read one after the other
+ * @param mapF the stream to read
+ * @param mapName the name of the map, for the error messages
+ * @return the map read
+ */
+Map parseMap(std::istream &mapF, const std::string &mapName);
 
 #endif //SOKOBAN_MAP_H
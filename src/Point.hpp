@@ -73,18 +73,6 @@ struct Point{
         return *this;
     }
 
-    /**
-     * @brief toInt6 encodes the point into a 6 bits int,
-     * used to encode the state in a 64 bits int
-     * a 64 bits int is returned in order to be able to do bit shifting
-     * and 'or' operators with others 64 bits ints
-     * @return the 6 bits encoded point into a 64 bits int
-     */
-    int64_t toInt6() const
-    {
-        return 0x3F & (((x-1) & 0x07) |  ( ((y-1) & 0x07) << 3));
-    }
-
     /**
      * @brief operator == if the point is the same as the given point
      * @param other
@@ -0,0 +1,416 @@
+#include "PuzzlePack.hpp"
+#include "Map.hpp"
+
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief MAGIC identifies the binary packs and their version
+ */
+const char MAGIC[8] = {'R', 'H', 'P', 'K', '0', '0', '0', '1'};
+
+/**
+ * @brief HEADER_SIZE size of the header of a binary pack : the magic and the number of puzzles
+ */
+const size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(uint32_t);
+
+/**
+ * @brief VERTICAL_BIT the bit of a car's length telling it is vertical
+ */
+const uint8_t VERTICAL_BIT = 0x80;
+
+/**
+ * @brief NO_EXIT the exit cell of a puzzle without exit
+ */
+const uint8_t NO_EXIT = 0xFF;
+
+/**
+ * @brief isBlank wether the char is a space or a line ending
+ * @param c the char to test
+ * @return wether it separates the puzzles
+ */
+bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief skipLine moves the cursor after the next line break
+ * @param cursor the position in the text
+ * @param end the end of the text
+ */
+void skipLine(const char *&cursor, const char *end)
+{
+    const char *lineEnd = static_cast<const char *>(std::memchr(cursor, '\n', end - cursor));
+    cursor = lineEnd ? lineEnd + 1 : end;
+}
+
+/**
+ * @brief skipPuzzle moves the cursor after the lines of a
+ * malformed puzzle, up to the next blank line
+ * @param cursor the position in the text
+ * @param end the end of the text
+ */
+void skipPuzzle(const char *&cursor, const char *end)
+{
+    while(cursor < end){
+        const char *line = cursor;
+        skipLine(cursor, end);
+        bool blank = true;
+        for(const char *c = line; c < cursor && blank; ++c) blank = isBlank(*c);
+        if(blank) break;
+    }
+}
+
+/**
+ * @brief readNumber reads a positive number, after spaces
+ * @param cursor the position in the text, moved after the number
+ * @param end the end of the text
+ * @return the number, -1 if there is none
+ */
+int readNumber(const char *&cursor, const char *end)
+{
+    while(cursor < end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+    if(cursor == end || *cursor < '0' || *cursor > '9') return -1;
+    int value = 0;
+    while(cursor < end && *cursor >= '0' && *cursor <= '9' && value < 1000){
+        value = value * 10 + (*cursor++ - '0');
+    }
+    return value;
+}
+
+/**
+ * @brief readSize reads the first line of a text puzzle, "height,width"
+ * @param cursor the position in the text, moved to the first row
+ * @param end the end of the text
+ * @param width the width read
+ * @param height the height read
+ * @return false if the line is not a size
+ */
+bool readSize(const char *&cursor, const char *end, int &width, int &height)
+{
+    height = readNumber(cursor, end);
+    if(height <= 0 || cursor == end || *cursor != ',') return false;
+    cursor++;
+    width = readNumber(cursor, end);
+    if(width <= 0) return false;
+    skipLine(cursor, end);
+    return true;
+}
+
+/**
+ * @brief puzzleName names a puzzle of a pack in the error messages
+ * @param path the path of the pack
+ * @param index the index of the puzzle
+ * @return the name of the puzzle
+ */
+std::string puzzleName(const std::string &path, size_t index)
+{
+    return "puzzle " + std::to_string(index + 1) + " of " + path;
+}
+
+/**
+ * @brief The BinaryCar struct a car of a puzzle of a binary pack
+ */
+struct BinaryCar{
+    int8 code;
+    int first;
+    int length;
+    int step;
+};
+
+/**
+ * @brief binaryBoard reads the size, walls and exit of a puzzle of a binary pack
+ * @param record the bytes of the puzzle
+ * @param name the name of the puzzle, for the error messages
+ * @return the map of the puzzle, without its cars
+ */
+Map binaryBoard(const uint8_t *record, const std::string &name)
+{
+    int width = record[0];
+    int height = record[1];
+    int cells = width * height;
+    Map map(width, height);
+    const uint8_t *walls = record + 4;
+    for(int cell = 0; cell < cells; ++cell){
+        if(walls[cell / 8] & (1 << (cell % 8))) map.setValue(cell % width, cell / width, 'x');
+    }
+    if(record[2] != NO_EXIT){
+        if(record[2] >= cells) throw std::runtime_error("The exit of the " + name + " is outside of the map");
+        map.setValue(record[2] % width, record[2] / width, 'z');
+    }
+    return map;
+}
+
+/**
+ * @brief binaryCar reads a car of a puzzle of a binary pack, throws
+ * an exception if it goes out of the map
+ * @param record the bytes of the puzzle
+ * @param index the index of the car in the puzzle
+ * @param name the name of the puzzle, for the error messages
+ * @return the car, its cells being first + i * step
+ */
+BinaryCar binaryCar(const uint8_t *record, int index, const std::string &name)
+{
+    int width = record[0];
+    int cells = width * record[1];
+    const uint8_t *car = record + 4 + (cells + 7) / 8 + 3 * index;
+    BinaryCar result{static_cast<int8>(car[0]), car[1], car[2] & ~VERTICAL_BIT, car[2] & VERTICAL_BIT ? width : 1};
+    int last = result.first + (result.length - 1) * result.step;
+    if(car[0] >= MAX_CARS || last >= cells || (result.step == 1 && result.first / width != last / width)){
+        throw std::runtime_error("The car " + std::to_string(index + 1) + " of the " + name + " is outside of the map");
+    }
+    return result;
+}
+
+/**
+ * @brief binarySize size of a puzzle of a binary pack
+ * @param record the first bytes of the puzzle
+ * @return the number of bytes of the puzzle
+ */
+size_t binarySize(const uint8_t *record)
+{
+    return 4 + (record[0] * record[1] + 7) / 8 + 3 * record[3];
+}
+
+}
+
+PuzzlePack::PuzzlePack():
+    m_path(),
+    m_data(nullptr),
+    m_size(0),
+    m_binary(false),
+    m_offsets()
+{
+
+}
+
+PuzzlePack::~PuzzlePack()
+{
+    close();
+}
+
+size_t PuzzlePack::writeBinary(const std::string &path, const std::vector<std::string> &sources)
+{
+    std::vector<uint8_t> data(HEADER_SIZE, 0);
+    std::memcpy(data.data(), MAGIC, sizeof(MAGIC));
+    uint32_t count = 0;
+    for(const std::string &source : sources){
+        PuzzlePack pack;
+        if(!pack.open(source)) throw std::runtime_error("Can't open the puzzle " + source);
+        for(size_t i = 0; i < pack.size(); ++i, ++count){
+            encode(pack.map(i), puzzleName(source, i), data);
+        }
+    }
+    std::memcpy(data.data() + sizeof(MAGIC), &count, sizeof(count));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()) throw std::runtime_error("Can't create the pack " + path);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    if(!file) throw std::runtime_error("Can't write the pack " + path);
+    return count;
+}
+
+void PuzzlePack::encode(const Map &map, const std::string &name, std::vector<uint8_t> &data)
+{
+    int width = map.width();
+    int height = map.height();
+    size_t record = data.size();
+    data.resize(record + 4 + (width * height + 7) / 8, 0);
+    data[record] = static_cast<uint8_t>(width);
+    data[record + 1] = static_cast<uint8_t>(height);
+    data[record + 2] = NO_EXIT;
+
+    bool seen[MAX_CARS] = {};
+    uint8_t carCount = 0;
+    for(int y = 0; y < height; ++y){
+        for(int x = 0; x < width; ++x){
+            int cell = y * width + x;
+            char value = map.at(x, y);
+            if(value == 'x'){
+                data[record + 4 + cell / 8] |= 1 << (cell % 8);
+            } else if(value == 'z'){
+                data[record + 2] = static_cast<uint8_t>(cell);
+            } else if(value != ' '){
+                int code = value;
+                if(code < 0 || code >= MAX_CARS) throw std::runtime_error("The " + name + " has an unknown cell");
+                if(seen[code]) continue;
+                seen[code] = true;
+                carCount++;
+                // The first cell of a car is its top left one, it is vertical if it goes down
+                bool vertical = y + 1 < height && map.at(x, y + 1) == value;
+                int length = 1;
+                while(vertical ? map.at(x, y + length) == value : map.at(x + length, y) == value) length++;
+                data.push_back(static_cast<uint8_t>(code));
+                data.push_back(static_cast<uint8_t>(cell));
+                data.push_back(static_cast<uint8_t>(length | (vertical ? VERTICAL_BIT : 0)));
+            }
+        }
+    }
+    data[record + 3] = carCount;
+}
+
+bool PuzzlePack::open(const std::string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat info;
+    if(fstat(fd, &info) != 0){
+        ::close(fd);
+        return false;
+    }
+    m_path = path;
+    if(info.st_size > 0){
+        void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(data == MAP_FAILED){
+            ::close(fd);
+            return false;
+        }
+        // The puzzles are read once, front to back
+        madvise(data, info.st_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char *>(data);
+        m_size = info.st_size;
+    }
+    ::close(fd);
+
+    m_binary = m_size >= HEADER_SIZE && std::memcmp(m_data, MAGIC, sizeof(MAGIC)) == 0;
+    if(!m_binary){
+        indexText();
+    } else if(!indexBinary()){
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PuzzlePack::close()
+{
+    if(m_data) munmap(const_cast<char *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_binary = false;
+    m_offsets.clear();
+}
+
+size_t PuzzlePack::size() const
+{
+    return m_offsets.size();
+}
+
+void PuzzlePack::puzzle(size_t index, Map &board, State &start) const
+{
+    start = State();
+    if(!m_binary){
+        board = map(index);
+        start.extractFrom(board);
+        return;
+    }
+
+    const uint8_t *record = reinterpret_cast<const uint8_t *>(m_data + m_offsets[index]);
+    std::string name = puzzleName(m_path, index);
+    board = binaryBoard(record, name);
+    int width = board.width();
+    BitMask taken = 0;
+    for(int cell = 0; cell < width * board.height(); ++cell){
+        if(board.at(cell % width, cell / width) != ' ') taken |= BitMask(1) << cell;
+    }
+    for(int c = 0; c < record[3]; ++c){
+        BinaryCar car = binaryCar(record, c, name);
+        for(int i = 0; i < car.length; ++i){
+            BitMask cell = BitMask(1) << (car.first + i * car.step);
+            if(taken & cell){
+                throw std::runtime_error("The car " + std::to_string(c + 1) + " of the " + name +
+                                         " overlaps a wall or another car");
+            }
+            taken |= cell;
+        }
+        // The origin of a car is its first cell along its line, as Map::getCar finds it
+        int x = car.first % width;
+        int y = car.first / width;
+        bool vertical = car.step != 1;
+        start.addCar(board.addCar(car.code, static_cast<int8>(car.length),
+                                  vertical ? Orientation::VERTICAL : Orientation::HORIZONTAL,
+                                  static_cast<int8>(vertical ? x : y), static_cast<int8>(vertical ? y : x)));
+    }
+    start.finishCars(board);
+}
+
+Map PuzzlePack::map(size_t index) const
+{
+    const char *cursor = m_data + m_offsets[index];
+    const char *end = m_data + m_size;
+
+    if(m_binary){
+        const uint8_t *record = reinterpret_cast<const uint8_t *>(cursor);
+        std::string name = puzzleName(m_path, index);
+        Map map = binaryBoard(record, name);
+        for(int c = 0; c < record[3]; ++c){
+            BinaryCar car = binaryCar(record, c, name);
+            for(int i = 0; i < car.length; ++i){
+                int cell = car.first + i * car.step;
+                map.setValue(cell % map.width(), cell / map.width(), static_cast<char>('a' + car.code));
+            }
+        }
+        return map;
+    }
+
+    int width = 0;
+    int height = 0;
+    if(!readSize(cursor, end, width, height)){
+        throw std::runtime_error("The first line of the " + puzzleName(m_path, index) + " must be the size of the map");
+    }
+    Map map(width, height);
+    for(int y = 0; y < height; ++y){
+        for(int x = 0; x < width; ++x){
+            if(cursor == end || *cursor == '\r' || *cursor == '\n'){
+                throw std::runtime_error("The row " + std::to_string(y + 1) + " of the " +
+                                         puzzleName(m_path, index) + " is too short");
+            }
+            map.setValue(x, y, *cursor++);
+        }
+        skipLine(cursor, end);
+    }
+    return map;
+}
+
+void PuzzlePack::indexText()
+{
+    const char *cursor = m_data;
+    const char *end = m_data + m_size;
+    while(cursor < end){
+        while(cursor < end && isBlank(*cursor)) cursor++;
+        if(cursor == end) break;
+        m_offsets.push_back(cursor - m_data);
+        int width = 0;
+        int height = 0;
+        if(!readSize(cursor, end, width, height)){
+            // Its lines are skipped, reading it reports the error
+            skipPuzzle(cursor, end);
+            continue;
+        }
+        for(int y = 0; y < height; ++y) skipLine(cursor, end);
+    }
+}
+
+bool PuzzlePack::indexBinary()
+{
+    uint32_t count = 0;
+    std::memcpy(&count, m_data + sizeof(MAGIC), sizeof(count));
+    m_offsets.reserve(count);
+    size_t offset = HEADER_SIZE;
+    for(uint32_t i = 0; i < count; ++i){
+        if(offset + 4 > m_size) return false;
+        m_offsets.push_back(offset);
+        offset += binarySize(reinterpret_cast<const uint8_t *>(m_data + offset));
+    }
+    return offset <= m_size;
+}
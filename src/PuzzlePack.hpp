@@ -0,0 +1,136 @@
+#ifndef PUZZLEPACK_HPP
+#define PUZZLEPACK_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class Map;
+class State;
+
+/**
+ * @brief The PuzzlePack class a file of puzzles, memory-mapped and read
+ * in place, without copying its lines. A pack is either :
+ *  - text : puzzles written as in the puzzle files, one after the other,
+ *    with blank lines between them or not (a puzzle file is a pack of one)
+ *  - binary : the magic "RHPK0001", the number of puzzles on 4 bytes,
+ *    then for every puzzle its width, height, exit cell (0xFF without exit)
+ *    and number of cars on a byte each, the walls as one bit per cell
+ *    (row-major, lowest bit first, rounded up to a byte), and every car on
+ *    3 bytes : its code, its first cell, and its length with the highest
+ *    bit set when it is vertical
+ * Opening a pack only finds where every puzzle starts, the puzzles are
+ * parsed when they are asked for, straight from the mapped file to the map.
+ * The cars of a binary puzzle are read as they are stored, without looking
+ * for them on the map
+ */
+class PuzzlePack
+{
+public:
+    /**
+     * @brief PuzzlePack empty constructor, for a closed pack
+     */
+    PuzzlePack();
+
+    ~PuzzlePack();
+
+    PuzzlePack(const PuzzlePack &) = delete;
+    PuzzlePack &operator=(const PuzzlePack &) = delete;
+
+    /**
+     * @brief writeBinary saves the puzzles of other packs (or puzzle files)
+     * in a binary pack, reading them one at a time, throws an exception if
+     * a file can't be read or written, or a puzzle can't be encoded
+     * @param path the file to create
+     * @param sources the packs to read
+     * @return the number of puzzles written
+     */
+    static size_t writeBinary(const std::string &path, const std::vector<std::string> &sources);
+
+    /**
+     * @brief open maps the given file in memory, and finds its puzzles
+     * @param path the pack file
+     * @return false if the file can't be opened, or is a truncated binary pack
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief close unmaps the file
+     */
+    void close();
+
+    /**
+     * @brief size number of puzzles of the pack
+     * @return the number of puzzles
+     */
+    size_t size() const;
+
+    /**
+     * @brief map reads a puzzle of the pack, throws an
+     * exception if the puzzle is malformed
+     * @param index the index of the puzzle
+     * @return the map of the puzzle, with its cars
+     */
+    Map map(size_t index) const;
+
+    /**
+     * @brief puzzle reads a puzzle of the pack, ready to be solved, throws
+     * an exception if the puzzle is malformed or its cars can't be handled.
+     * The cars of a binary puzzle are added to the board and the state from
+     * their record, those of a text puzzle are extracted from its map
+     * @param index the index of the puzzle
+     * @param board the map of the puzzle, without its cars
+     * @param start the starting state
+     */
+    void puzzle(size_t index, Map &board, State &start) const;
+
+private:
+    /**
+     * @brief encode appends a puzzle to a binary pack
+     * @param map the map of the puzzle, with its cars
+     * @param name the name of the puzzle, for the error messages
+     * @param data the content of the pack
+     */
+    static void encode(const Map &map, const std::string &name, std::vector<uint8_t> &data);
+
+    /**
+     * @brief indexText finds the puzzles of a text pack, a puzzle without
+     * a size is indexed up to the next blank line, so that reading it
+     * reports the error, and the next puzzles are still found
+     */
+    void indexText();
+
+    /**
+     * @brief indexBinary finds the puzzles of a binary pack
+     * @return false if the pack is truncated
+     */
+    bool indexBinary();
+
+    /**
+     * @brief m_path the path of the pack, for the error messages
+     */
+    std::string m_path;
+
+    /**
+     * @brief m_data the mapped file, nullptr when closed or empty
+     */
+    const char *m_data;
+
+    /**
+     * @brief m_size size of the mapped file
+     */
+    size_t m_size;
+
+    /**
+     * @brief m_binary wether the pack is a binary one
+     */
+    bool m_binary;
+
+    /**
+     * @brief m_offsets where every puzzle starts in the file
+     */
+    std::vector<size_t> m_offsets;
+};
+
+#endif // PUZZLEPACK_HPP
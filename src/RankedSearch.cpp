@@ -0,0 +1,176 @@
+#include "RankedSearch.hpp"
+#include "Map.hpp"
+#include "SearchStats.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/**
+ * @brief The DepthArray class 2 bits for every rank : 0 for a
+ * state not reached, else its depth modulo 3 plus one
+ */
+class DepthArray
+{
+public:
+    /**
+     * @brief DepthArray constructor, no state is reached
+     * @param words the memory of the array, refilled
+     * @param count the number of ranks
+     */
+    DepthArray(std::vector<uint64_t> &words, uint64_t count):
+        m_count(count),
+        m_words(words)
+    {
+        m_words.assign((count + 31) / 32, 0);
+    }
+
+    /**
+     * @brief get the mark of a state
+     * @param rank the rank of the state
+     * @return 0 if the state was not reached (or has no rank), else its depth modulo 3 plus one
+     */
+    int get(uint64_t rank) const
+    {
+        if(rank >= m_count) return 0;
+        return static_cast<int>(m_words[rank >> 5] >> ((rank & 31) * 2)) & 3;
+    }
+
+    /**
+     * @brief reach marks a state, if it was not reached before
+     * @param rank the rank of the state
+     * @param depth the depth of the state
+     * @return wether the state was not reached before, false for a rank out of the array
+     */
+    bool reach(uint64_t rank, int depth)
+    {
+        RUSHHOUR_STATS_PHASE(VISITED_LOOKUP);
+        if(rank >= m_count) return false;
+        uint64_t &word = m_words[rank >> 5];
+        int shift = (rank & 31) * 2;
+        if((word >> shift) & 3) return false;
+        word |= static_cast<uint64_t>(mark(depth)) << shift;
+        return true;
+    }
+
+    /**
+     * @brief mark the value stored for a depth
+     * @param depth the depth of a state
+     * @return the depth modulo 3 plus one
+     */
+    static int mark(int depth)
+    {
+        return depth % 3 + 1;
+    }
+
+    /**
+     * @brief memoryBytes memory used by the array
+     * @return the number of bytes
+     */
+    size_t memoryBytes() const
+    {
+        return m_words.capacity() * sizeof(uint64_t);
+    }
+
+    /**
+     * @brief count the number of ranks
+     * @return the number of ranks
+     */
+    uint64_t count() const
+    {
+        return m_count;
+    }
+
+private:
+    uint64_t m_count;
+    std::vector<uint64_t> &m_words;
+};
+
+}
+
+size_t rankedSearchBytes(const Map &map)
+{
+    uint64_t count = map.encoder().rankCount();
+    if(!count) return 0;
+    return static_cast<size_t>((count + 31) / 32 * sizeof(uint64_t));
+}
+
+SearchResult rankedBreadthFirstSearch(Map &map, const State &start)
+{
+    std::vector<uint64_t> words;
+    return rankedBreadthFirstSearch(map, start, words);
+}
+
+SearchResult rankedBreadthFirstSearch(Map &map, const State &start, std::vector<uint64_t> &words)
+{
+    SearchResult result;
+    const StateEncoder &encoder = map.encoder();
+    DepthArray depths(words, encoder.rankCount());
+    std::vector<uint64_t> layer(1, start.rank(encoder));
+    std::vector<uint64_t> next;
+    std::vector<Move> moves;
+    if(!depths.reach(layer[0], 0)){
+        throw std::runtime_error("The starting state has no rank among the " +
+                                 std::to_string(depths.count()) + " placements of the cars");
+    }
+
+    SearchStats *stats = SearchStats::current();
+    State solution;
+    int depth = 0;
+    for(; !layer.empty() && !result.found; ++depth){
+        if(stats) stats->beginLayer(depth, layer.size());
+        size_t expanded = 0;
+        size_t generated = 0;
+        for(uint64_t rank : layer){
+            State current = State::fromRank(rank, encoder);
+            if(current.isSolutionOf(map)){
+                result.found = true;
+                solution = current;
+                break;
+            }
+            expanded++;
+            moves.clear();
+            current.moves(map, moves);
+            generated += moves.size();
+            for(const Move &move : moves){
+                State successor = current;
+                successor.play(move);
+                uint64_t successorRank = successor.rank(encoder);
+                if(depths.reach(successorRank, depth + 1)) next.push_back(successorRank);
+            }
+        }
+        RUSHHOUR_STATS_GENERATED(generated);
+        result.explored += expanded;
+        if(stats){
+            size_t memory = depths.memoryBytes() + (layer.capacity() + next.capacity()) * sizeof(uint64_t);
+            stats->endLayer(expanded, result.found ? 0 : next.size(), memory);
+        }
+        if(result.found) break;
+        layer.swap(next);
+        next.clear();
+    }
+    if(!result.found) return result;
+
+    // Every state of a layer has a neighbour marked with the depth before,
+    // the neighbours of the next layer having another mark
+    result.path.push_back(solution);
+    for(int d = depth - 1; d >= 0; --d){
+        const State current = result.path.back();
+        moves.clear();
+        current.moves(map, moves);
+        for(const Move &move : moves){
+            State previous = current;
+            previous.play(move);
+            if(depths.get(previous.rank(encoder)) == DepthArray::mark(d)){
+                result.path.push_back(previous);
+                break;
+            }
+        }
+    }
+    std::reverse(result.path.begin(), result.path.end());
+    return result;
+}
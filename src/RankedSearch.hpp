@@ -0,0 +1,47 @@
+#ifndef RANKEDSEARCH_HPP
+#define RANKEDSEARCH_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "Search.hpp"
+
+/**
+ * @brief rankedSearchBytes memory used by rankedBreadthFirstSearch for
+ * the depths of the states, without the layers being expanded
+ * @param map the map to solve
+ * @return the number of bytes, 0 if the ranks of the map don't fit in 63 bits
+ */
+size_t rankedSearchBytes(const Map &map);
+
+/**
+ * @brief rankedBreadthFirstSearch finds the shortest solution as
+ * breadthFirstSearch, without hashing the states : each car slides
+ * on a fixed track, so a state is a number whose digits are the origins
+ * of the cars (see State::rank), and the search keeps 2 bits for every
+ * possible number : 0 for a state not reached yet, or its depth modulo 3
+ * plus one. A state of the previous layer is then always a neighbour
+ * with the depth before, so the solution is rebuilt without parent links.
+ * The memory does not depend on the states reached, but on all the
+ * placements of the cars, overlapping or not, so it pays off when the
+ * puzzle reaches a good part of them
+ * @param map the map to solve, used as the working board, its
+ * rankedSearchBytes must not be 0
+ * @param start the starting state
+ * @return the result of the search
+ */
+SearchResult rankedBreadthFirstSearch(Map &map, const State &start);
+
+/**
+ * @brief rankedBreadthFirstSearch as rankedBreadthFirstSearch, keeping
+ * the depths in the given words, which are refilled, so that their
+ * memory is reused from one search to the other
+ * @param map the map to solve, used as the working board, its
+ * rankedSearchBytes must not be 0
+ * @param start the starting state
+ * @param words the memory of the depths
+ * @return the result of the search
+ */
+SearchResult rankedBreadthFirstSearch(Map &map, const State &start, std::vector<uint64_t> &words);
+
+#endif // RANKEDSEARCH_HPP
@@ -0,0 +1,475 @@
+#include "Search.hpp"
+#include "Map.hpp"
+#include "ThreadPool.hpp"
+#include "SearchTree.hpp"
+#include "StateMap.hpp"
+#include "TranspositionTable.hpp"
+#include "SearchStats.hpp"
+#include "StateSet.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+/**
+ * @brief LAYER_CHUNK number of states of a layer expanded by a single task
+ */
+const size_t LAYER_CHUNK = 256;
+
+/**
+ * @brief MAX_DEPTH the iterative deepening gives up
+ * when the bound goes above this number of moves
+ */
+const int MAX_DEPTH = 1024;
+
+/**
+ * @brief SHARDS_PER_WORKER number of shards of the new nodes of a layer
+ * for every thread, so that the shards stay even between the threads
+ */
+const int SHARDS_PER_WORKER = 8;
+
+/**
+ * @brief The Candidate struct a successor that was not in the tree
+ * before the layer, with its parent and the move reaching it
+ */
+struct Candidate{
+    StateKey key;
+    int32_t parent;
+    uint16_t move;
+};
+
+/**
+ * @brief The WorkerData struct what a thread needs to expand
+ * states : its own board, the successors it found that were
+ * not in the tree before the layer (by shard of their key),
+ * the set removing the duplicates of a shard, and its own stats
+ */
+struct WorkerData{
+    Map map;
+    std::vector<Move> moves;
+    std::vector<std::vector<Candidate>> shards;
+    StateSet seen;
+    SearchStats stats;
+};
+
+/**
+ * @brief tracePath rebuilds the path from the first state to the given one
+ * @param states all the stored states
+ * @param anc the index of the predecessor of each state (-1 for the first one)
+ * @param last index of the last state of the path
+ * @return the states of the path, the first state first
+ */
+std::vector<State> tracePath(const std::vector<State> &states, const std::vector<int> &anc, int last)
+{
+    std::vector<State> path;
+    for(int i = last; i != -1; i = anc[i]) path.push_back(states[i]);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+/**
+ * @brief The IterativeDeepening class the state of an IDA* search :
+ * the board (always showing the last state of the path), the path
+ * followed, and the moves left to try at every depth
+ */
+class IterativeDeepening
+{
+public:
+    /**
+     * @brief IterativeDeepening constructor
+     * @param map the map to solve, used as the working board
+     * @param heuristic the lower bound used to estimate the remaining moves
+     * @param table the transposition table
+     */
+    IterativeDeepening(Map &map, Heuristic heuristic, TranspositionTable &table):
+        m_map(map),
+        m_heuristic(heuristic),
+        m_table(table),
+        m_path(),
+        m_moves(),
+        m_explored(0),
+        m_iteration(0),
+        m_nextBound(0)
+    {
+    }
+
+    /**
+     * @brief run searches deeper and deeper until a solution is found
+     * @param start the starting state
+     * @return the result of the search
+     */
+    SearchResult run(const State &start)
+    {
+        SearchResult result;
+        m_path.assign(1, start);
+        m_map.placeState(start);
+        int bound = estimateMoves(m_map, start, m_heuristic);
+        SearchStats *stats = SearchStats::current();
+        while(bound < MAX_DEPTH){
+            m_iteration = m_table.nextIteration();
+            m_nextBound = UNSOLVABLE;
+            m_moves.resize(bound + 1);
+            size_t explored = m_explored;
+            if(stats) stats->beginLayer(bound, 1);
+            bool found = search(0, bound, -1);
+            if(stats){
+                size_t memory = m_table.memoryBytes() + m_path.capacity() * sizeof(State);
+                stats->endLayer(m_explored - explored, 0, memory);
+            }
+            if(found){
+                result.found = true;
+                result.path = m_path;
+                break;
+            }
+            bound = m_nextBound;
+        }
+        result.explored = m_explored;
+        return result;
+    }
+
+private:
+    /**
+     * @brief search depth-first search from the last state of the path
+     * @param depth the depth of the last state of the path
+     * @param bound the maximum depth plus estimation allowed
+     * @param lastCar the car moved to reach the state, -1 for the first state
+     * @return wether a solution was found, the path then ends with the solution
+     */
+    bool search(int depth, int bound, int lastCar)
+    {
+        State current = m_path.back();
+        int estimate = estimateMoves(m_map, current, m_heuristic);
+        if(depth + estimate > bound){
+            m_nextBound = std::min(m_nextBound, depth + estimate);
+            return false;
+        }
+        if(estimate == 0) return true;
+        if(m_table.alreadyReached(current.key(m_map.encoder()), depth, m_iteration)) return false;
+        m_explored++;
+
+        std::vector<Move> &moves = m_moves[depth];
+        moves.clear();
+        current.moves(m_map, moves);
+        for(const Move &move : moves){
+            // Moving the same car twice in a row is never shorter than a single move
+            if(move.car == lastCar) continue;
+            const StateCar &car = current.car(move.car);
+            m_map.moveCar(car, move.distance);
+            m_path.push_back(current);
+            m_path.back().play(move);
+            if(search(depth + 1, bound, move.car)) return true;
+            m_path.pop_back();
+            m_map.undoMove(car, move.distance);
+        }
+        return false;
+    }
+
+    Map &m_map;
+    Heuristic m_heuristic;
+    TranspositionTable &m_table;
+    std::vector<State> m_path;
+    std::vector<std::vector<Move>> m_moves;
+    size_t m_explored;
+    int m_iteration;
+    int m_nextBound;
+};
+
+}
+
+SearchResult::SearchResult():
+    found(false),
+    path(),
+    explored(0)
+{
+
+}
+
+int SearchResult::moves() const
+{
+    return found ? static_cast<int>(path.size()) - 1 : -1;
+}
+
+SearchResult breadthFirstSearch(Map &map, const State &start)
+{
+    SearchTree tree(100000);
+    return breadthFirstSearch(map, start, tree);
+}
+
+SearchResult breadthFirstSearch(Map &map, const State &start, SearchTree &tree)
+{
+    SearchResult result;
+    const StateEncoder &encoder = map.encoder();
+    tree.clear();
+    tree.insert(start.key(encoder), SearchTree::NO_PARENT, Move());
+    std::vector<Move> moves;
+
+    SearchStats *stats = SearchStats::current();
+    size_t layerStart = 0;
+    size_t layerEnd = 1;
+    int depth = 0;
+    if(stats) stats->beginLayer(depth, 1);
+
+    size_t cursor = 0;
+    while(cursor < tree.size()){
+        if(cursor == layerEnd){
+            if(stats){
+                stats->endLayer(layerEnd - layerStart, tree.size() - layerEnd, tree.memoryBytes());
+                stats->beginLayer(++depth, tree.size() - layerEnd);
+            }
+            layerStart = layerEnd;
+            layerEnd = tree.size();
+        }
+        State current = State::fromKey(tree.key(cursor), encoder);
+        if(current.isSolutionOf(map)){
+            result.found = true;
+            result.path = tree.path(start, cursor);
+            break;
+        }
+        moves.clear();
+        current.moves(map, moves);
+        for(const Move &move : moves){
+            State next = current;
+            next.play(move);
+            tree.insert(next.key(encoder), static_cast<int32_t>(cursor), move);
+        }
+        cursor++;
+    }
+    if(stats) stats->endLayer(cursor - layerStart, tree.size() - layerEnd, tree.memoryBytes());
+    result.explored = cursor;
+    return result;
+}
+
+SearchResult parallelBreadthFirstSearch(const Map &map, const State &start, int threadCount)
+{
+    ThreadPool pool(threadCount);
+    SearchTree tree(100000);
+    return parallelBreadthFirstSearch(map, start, pool, tree);
+}
+
+SearchResult parallelBreadthFirstSearch(const Map &map, const State &start, ThreadPool &pool, SearchTree &tree)
+{
+    SearchResult result;
+    int shardBits = 3;
+    while((1 << shardBits) < SHARDS_PER_WORKER * pool.size()) shardBits++;
+    const size_t shardCount = size_t(1) << shardBits;
+    std::vector<WorkerData> workers(pool.size(), WorkerData{map, {}, std::vector<std::vector<Candidate>>(shardCount),
+                                                            StateSet(), SearchStats()});
+    std::vector<std::vector<Candidate>> kept(shardCount);
+    std::vector<size_t> firstNodes(shardCount);
+    SearchStats *stats = SearchStats::current();
+    int depth = 0;
+    const StateEncoder &encoder = map.encoder();
+
+    // The threads fill their own stats, added to the search's after every step
+    auto runStep = [&](size_t taskCount, const std::function<void(size_t, WorkerData &)> &task){
+        pool.run(taskCount, [&](size_t index, int worker){
+            WorkerData &data = workers[worker];
+            if(stats) data.stats.activate();
+            task(index, data);
+            if(stats) data.stats.deactivate();
+        });
+        if(stats){
+            for(WorkerData &data : workers) stats->absorb(data.stats);
+        }
+    };
+
+    tree.clear();
+    tree.insert(start.key(encoder), SearchTree::NO_PARENT, Move());
+
+    size_t layerStart = 0;
+    while(layerStart < tree.size()){
+        size_t layerEnd = tree.size();
+        if(stats) stats->beginLayer(depth++, layerEnd - layerStart);
+
+        // Every state of the layer is tested, then expanded unless it is solved :
+        // the successors not in the tree yet are kept by the shard of their key.
+        // The tree is only read during this step
+        std::atomic<size_t> solved(SIZE_MAX);
+        size_t chunkCount = (layerEnd - layerStart + LAYER_CHUNK - 1) / LAYER_CHUNK;
+        runStep(chunkCount, [&](size_t chunk, WorkerData &data){
+            size_t first = layerStart + chunk * LAYER_CHUNK;
+            size_t last = std::min(first + LAYER_CHUNK, layerEnd);
+            for(size_t i = first; i < last && i < solved.load(std::memory_order_relaxed); ++i){
+                State current = State::fromKey(tree.key(i), encoder);
+                if(current.isSolutionOf(data.map)){
+                    size_t known = solved.load();
+                    while(i < known && !solved.compare_exchange_weak(known, i)){}
+                    break;
+                }
+                data.moves.clear();
+                current.moves(data.map, data.moves);
+                for(const Move &move : data.moves){
+                    State next = current;
+                    next.play(move);
+                    StateKey key = next.key(encoder);
+                    bool known;
+                    {
+                        RUSHHOUR_STATS_PHASE(VISITED_LOOKUP);
+                        known = tree.contains(key);
+                    }
+                    if(!known){
+                        data.shards[hashKey(key) >> (64 - shardBits)].push_back(
+                                    Candidate{key, static_cast<int32_t>(i), move.toCode()});
+                    }
+                }
+            }
+        });
+
+        // The layer holds a solution, the one found first in the tree is kept
+        if(solved != SIZE_MAX){
+            result.found = true;
+            result.path = tree.path(start, solved);
+            result.explored = solved;
+            for(WorkerData &data : workers){
+                for(std::vector<Candidate> &shard : data.shards) shard.clear();
+            }
+            if(stats) stats->endLayer(solved - layerStart, 0, tree.memoryBytes());
+            return result;
+        }
+
+        // Every shard removes its duplicates, found by several states or threads,
+        // the shards holding different keys, then the nodes are placed in parallel.
+        // The candidates are sorted by parent first, so that the tree does not
+        // depend on which thread expanded which chunk
+        runStep(shardCount, [&](size_t shard, WorkerData &data){
+            std::vector<Candidate> &candidates = kept[shard];
+            candidates.clear();
+            for(WorkerData &from : workers){
+                candidates.insert(candidates.end(), from.shards[shard].begin(), from.shards[shard].end());
+                from.shards[shard].clear();
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b){
+                return a.parent != b.parent ? a.parent < b.parent : a.move < b.move;
+            });
+            data.seen.clear();
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&data](const Candidate &candidate){
+                return !data.seen.insert(candidate.key);
+            }), candidates.end());
+        });
+        size_t added = 0;
+        for(size_t shard = 0; shard < shardCount; ++shard){
+            firstNodes[shard] = added;
+            added += kept[shard].size();
+        }
+        size_t firstNode = tree.extend(added);
+        runStep(shardCount, [&](size_t shard, WorkerData &){
+            size_t node = firstNode + firstNodes[shard];
+            for(const Candidate &candidate : kept[shard]){
+                tree.place(node++, candidate.key, candidate.parent, Move::fromCode(candidate.move));
+            }
+        });
+
+        if(stats) stats->endLayer(layerEnd - layerStart, added, tree.memoryBytes());
+        layerStart = layerEnd;
+    }
+    result.explored = tree.size();
+    return result;
+}
+
+SearchResult aStarSearch(Map &map, const State &start, Heuristic heuristic)
+{
+    AStarMemory containers;
+    return aStarSearch(map, start, heuristic, containers);
+}
+
+SearchResult aStarSearch(Map &map, const State &start, Heuristic heuristic, AStarMemory &containers)
+{
+    SearchResult result;
+    int startEstimate = estimateMoves(map, start, heuristic);
+    if(startEstimate >= UNSOLVABLE) return result;
+
+    // A state reached again with a shorter path is stored a second time,
+    // the index of its latest copy is kept in 'best' so the older one is skipped
+    std::vector<State> &states = containers.states;
+    std::vector<int> &anc = containers.anc;
+    std::vector<int> &depths = containers.depths;
+    StateMap<int> &best = containers.best;
+    std::vector<std::vector<int>> &buckets = containers.buckets;
+    states.assign(1, start);
+    anc.assign(1, -1);
+    depths.assign(1, 0);
+    const StateEncoder &encoder = map.encoder();
+    best.clear();
+    best.insert(start.key(encoder), 0);
+
+    // The buckets of the previous searches are kept, past the last one used
+    size_t lastBucket = startEstimate;
+    for(std::vector<int> &bucket : buckets) bucket.clear();
+    if(buckets.size() <= lastBucket) buckets.resize(lastBucket + 1);
+    buckets[startEstimate].push_back(0);
+    std::vector<State> successors;
+
+    SearchStats *stats = SearchStats::current();
+    size_t layerExpanded = 0;
+    size_t layerAdded = 0;
+    auto memory = [&]{
+        size_t open = 0;
+        for(const auto &bucket : buckets) open += bucket.capacity() * sizeof(int);
+        return states.capacity() * sizeof(State) + anc.capacity() * sizeof(int) +
+                depths.capacity() * sizeof(int) + best.memoryBytes() + open;
+    };
+
+    for(size_t f = startEstimate; f <= lastBucket; ++f){
+        if(stats){
+            stats->beginLayer(static_cast<int>(f), buckets[f].size());
+            layerExpanded = layerAdded = 0;
+        }
+        while(!buckets[f].empty()){
+            int index = buckets[f].back();
+            buckets[f].pop_back();
+            State current = states[index];
+            if(*best.find(current.key(encoder)) != index) continue;
+
+            if(current.isSolutionOf(map)){
+                result.found = true;
+                result.path = tracePath(states, anc, index);
+                if(stats) stats->endLayer(layerExpanded, layerAdded, memory());
+                return result;
+            }
+            result.explored++;
+            layerExpanded++;
+
+            successors.clear();
+            current.successors(map, successors);
+            int depth = depths[index] + 1;
+            for(const State &next : successors){
+                StateKey key = next.key(encoder);
+                int *known = best.find(key);
+                if(known && depths[*known] <= depth) continue;
+
+                int estimate = estimateMoves(map, next, heuristic);
+                if(estimate >= UNSOLVABLE) continue;
+
+                int nextIndex = static_cast<int>(states.size());
+                states.push_back(next);
+                anc.push_back(index);
+                depths.push_back(depth);
+                if(known) *known = nextIndex;
+                else best.insert(key, nextIndex);
+
+                size_t bucket = depth + estimate;
+                if(bucket >= buckets.size()) buckets.resize(bucket + 1);
+                lastBucket = std::max(lastBucket, bucket);
+                buckets[bucket].push_back(nextIndex);
+                layerAdded++;
+            }
+        }
+        if(stats) stats->endLayer(layerExpanded, layerAdded, memory());
+    }
+    return result;
+}
+
+SearchResult idaStarSearch(Map &map, const State &start, Heuristic heuristic, size_t tableMegabytes)
+{
+    TranspositionTable table(tableMegabytes);
+    return idaStarSearch(map, start, heuristic, table);
+}
+
+SearchResult idaStarSearch(Map &map, const State &start, Heuristic heuristic, TranspositionTable &table)
+{
+    IterativeDeepening search(map, heuristic, table);
+    return search.run(start);
+}
@@ -0,0 +1,177 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include <vector>
+#include <cstddef>
+#include "State.hpp"
+#include "StateMap.hpp"
+#include "Heuristic.hpp"
+
+class Map;
+class SearchTree;
+class ThreadPool;
+class TranspositionTable;
+
+/**
+ * @brief The SearchResult struct what a search returns :
+ * wether a solution was found, the states from the start
+ * to the solution, and how much work was done
+ */
+struct SearchResult{
+
+    /**
+     * @brief SearchResult empty constructor, for a search without solution
+     */
+    SearchResult();
+
+    /**
+     * @brief moves number of moves of the solution
+     * @return the number of moves, -1 if no solution was found
+     */
+    int moves() const;
+
+    /**
+     * @brief found wether a solution was found
+     */
+    bool found;
+
+    /**
+     * @brief path all the states of the solution,
+     * from the starting state to the solved one
+     */
+    std::vector<State> path;
+
+    /**
+     * @brief explored number of states expanded by the search
+     */
+    size_t explored;
+};
+
+/**
+ * @brief The AStarMemory struct the containers of an A* search,
+ * emptied by every search but keeping their memory for the next one
+ */
+struct AStarMemory{
+
+    /**
+     * @brief states the states reached, a state reached again
+     * with a shorter path being stored a second time
+     */
+    std::vector<State> states;
+
+    /**
+     * @brief anc the index of the predecessor of each state
+     */
+    std::vector<int> anc;
+
+    /**
+     * @brief depths the depth of each state
+     */
+    std::vector<int> depths;
+
+    /**
+     * @brief best the index of the latest copy of every state reached
+     */
+    StateMap<int> best;
+
+    /**
+     * @brief buckets the states waiting to be expanded, by depth plus estimation
+     */
+    std::vector<std::vector<int>> buckets;
+};
+
+/**
+ * @brief breadthFirstSearch finds the shortest solution by exploring
+ * all the states, nearest first, on a single thread
+ * @param map the map to solve, used as the working board
+ * @param start the starting state
+ * @return the result of the search
+ */
+SearchResult breadthFirstSearch(Map &map, const State &start);
+
+/**
+ * @brief breadthFirstSearch as breadthFirstSearch, storing the states in
+ * the given tree, which is cleared first, so that its memory is reused
+ * from one search to the other
+ * @param map the map to solve, used as the working board
+ * @param start the starting state
+ * @param tree the tree to store the states in
+ * @return the result of the search
+ */
+SearchResult breadthFirstSearch(Map &map, const State &start, SearchTree &tree);
+
+/**
+ * @brief parallelBreadthFirstSearch finds the shortest solution by
+ * exploring all the states layer by layer (all the states at the same
+ * depth), each layer being split between the threads of a work-stealing pool
+ * @param map the map to solve, each thread works on its own copy
+ * @param start the starting state
+ * @param threadCount number of threads to use
+ * @return the result of the search
+ */
+SearchResult parallelBreadthFirstSearch(const Map &map, const State &start, int threadCount);
+
+/**
+ * @brief parallelBreadthFirstSearch as parallelBreadthFirstSearch, on the
+ * threads of the given pool and storing the states in the given tree,
+ * which is cleared first, so that both are reused from one search to the other
+ * @param map the map to solve, each thread works on its own copy
+ * @param start the starting state
+ * @param pool the threads to use
+ * @param tree the tree to store the states in
+ * @return the result of the search
+ */
+SearchResult parallelBreadthFirstSearch(const Map &map, const State &start, ThreadPool &pool, SearchTree &tree);
+
+/**
+ * @brief aStarSearch finds the shortest solution by expanding first the
+ * states with the lowest depth plus estimated number of remaining moves,
+ * since all the moves cost 1, the states waiting to be expanded are
+ * stored in buckets indexed by this sum
+ * @param map the map to solve, used as the working board
+ * @param start the starting state
+ * @param heuristic the lower bound used to estimate the remaining moves
+ * @return the result of the search
+ */
+SearchResult aStarSearch(Map &map, const State &start, Heuristic heuristic);
+
+/**
+ * @brief aStarSearch as aStarSearch, storing the states in the given
+ * containers, which are emptied first, so that their memory is reused
+ * from one search to the other
+ * @param map the map to solve, used as the working board
+ * @param start the starting state
+ * @param heuristic the lower bound used to estimate the remaining moves
+ * @param containers the containers to store the states in
+ * @return the result of the search
+ */
+SearchResult aStarSearch(Map &map, const State &start, Heuristic heuristic, AStarMemory &containers);
+
+/**
+ * @brief idaStarSearch finds the shortest solution with a series of
+ * depth-first searches, each one cutting the states whose depth plus
+ * estimated number of remaining moves is above a bound, the bound
+ * growing after every search. The states are moved on the map one
+ * car at a time, and the states already reached are remembered in a
+ * transposition table of fixed size, so the memory used does not
+ * depend on the number of states explored
+ * @param map the map to solve, used as the working board
+ * @param start the starting state
+ * @param heuristic the lower bound used to estimate the remaining moves
+ * @param tableMegabytes the size of the transposition table
+ * @return the result of the search
+ */
+SearchResult idaStarSearch(Map &map, const State &start, Heuristic heuristic, size_t tableMegabytes);
+
+/**
+ * @brief idaStarSearch as idaStarSearch, with the given transposition
+ * table, so that it is allocated once for all the searches
+ * @param map the map to solve, used as the working board
+ * @param start the starting state
+ * @param heuristic the lower bound used to estimate the remaining moves
+ * @param table the transposition table, the states of the previous searches are ignored
+ * @return the result of the search
+ */
+SearchResult idaStarSearch(Map &map, const State &start, Heuristic heuristic, TranspositionTable &table);
+
+#endif // SEARCH_HPP
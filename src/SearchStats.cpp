@@ -0,0 +1,186 @@
+#include "SearchStats.hpp"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief activeStats the stats filled by the current thread
+ */
+thread_local SearchStats *activeStats = nullptr;
+
+/**
+ * @brief PHASE_NAMES the names of the phases in the reports
+ */
+const char *PHASE_NAMES[PHASE_COUNT] = {
+    "move_generation",
+    "board_painting",
+    "serialization",
+    "visited_lookup"
+};
+
+}
+
+SearchStats::SearchStats():
+    m_origin(std::chrono::steady_clock::now()),
+    m_phaseNs(),
+    m_probeHistogram(),
+    m_lookups(0),
+    m_probes(0),
+    m_generated(0),
+    m_layers(),
+    m_layerOpen(false),
+    m_layerGenerated(0)
+{
+
+}
+
+SearchStats *SearchStats::current()
+{
+#ifdef RUSHHOUR_STATS
+    return activeStats;
+#else
+    return nullptr;
+#endif
+}
+
+void SearchStats::activate()
+{
+    m_origin = std::chrono::steady_clock::now();
+    activeStats = this;
+}
+
+void SearchStats::deactivate()
+{
+    if(m_layerOpen) endLayer(0, 0, 0);
+    if(activeStats == this) activeStats = nullptr;
+}
+
+void SearchStats::addTime(Phase phase, uint64_t nanoseconds)
+{
+    m_phaseNs[phase] += nanoseconds;
+}
+
+void SearchStats::recordProbe(int length)
+{
+    m_lookups++;
+    m_probes += length;
+    m_probeHistogram[std::min(length, MAX_PROBE)]++;
+}
+
+void SearchStats::addGenerated(size_t count)
+{
+    m_generated += count;
+}
+
+void SearchStats::absorb(SearchStats &other)
+{
+    for(int p = 0; p < PHASE_COUNT; ++p) m_phaseNs[p] += other.m_phaseNs[p];
+    for(int i = 0; i <= MAX_PROBE; ++i) m_probeHistogram[i] += other.m_probeHistogram[i];
+    m_lookups += other.m_lookups;
+    m_probes += other.m_probes;
+    m_generated += other.m_generated;
+    other.m_phaseNs.fill(0);
+    other.m_probeHistogram.fill(0);
+    other.m_lookups = 0;
+    other.m_probes = 0;
+    other.m_generated = 0;
+}
+
+void SearchStats::beginLayer(int depth, size_t frontier)
+{
+    if(m_layerOpen) endLayer(0, 0, 0);
+    Layer layer;
+    layer.depth = depth;
+    layer.frontier = frontier;
+    layer.expanded = 0;
+    layer.generated = 0;
+    layer.added = 0;
+    layer.memoryBytes = 0;
+    layer.startMs = elapsedMs();
+    layer.endMs = layer.startMs;
+    layer.phaseNs = m_phaseNs;
+    m_layers.push_back(layer);
+    m_layerOpen = true;
+    m_layerGenerated = m_generated;
+}
+
+void SearchStats::endLayer(size_t expanded, size_t added, size_t memoryBytes)
+{
+    if(!m_layerOpen) return;
+    Layer &layer = m_layers.back();
+    layer.expanded = expanded;
+    layer.generated = m_generated - m_layerGenerated;
+    layer.added = added;
+    layer.memoryBytes = memoryBytes;
+    layer.endMs = elapsedMs();
+    // The phase times were stored at the start of the layer, keep the difference
+    for(int p = 0; p < PHASE_COUNT; ++p) layer.phaseNs[p] = m_phaseNs[p] - layer.phaseNs[p];
+    m_layerOpen = false;
+}
+
+double SearchStats::elapsedMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_origin).count();
+}
+
+void SearchStats::writeJson(std::ostream &out) const
+{
+    out << "{\n  \"phases_ms\": {";
+    for(int p = 0; p < PHASE_COUNT; ++p){
+        out << (p ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": " << m_phaseNs[p] / 1e6;
+    }
+    out << "},\n";
+    out << "  \"visited_lookups\": " << m_lookups << ",\n";
+    out << "  \"mean_probe_length\": " << (m_lookups ? double(m_probes) / m_lookups : 0) << ",\n";
+    out << "  \"probe_length_histogram\": [";
+    for(int i = 0; i <= MAX_PROBE; ++i) out << (i ? ", " : "") << m_probeHistogram[i];
+    out << "],\n";
+    out << "  \"generated\": " << m_generated << ",\n";
+    out << "  \"layers\": [\n";
+    for(size_t i = 0; i < m_layers.size(); ++i){
+        const Layer &layer = m_layers[i];
+        out << "    {\"depth\": " << layer.depth
+            << ", \"frontier\": " << layer.frontier
+            << ", \"expanded\": " << layer.expanded
+            << ", \"generated\": " << layer.generated
+            << ", \"added\": " << layer.added
+            << ", \"branching_factor\": " << (layer.expanded ? double(layer.generated) / layer.expanded : 0)
+            << ", \"memory_bytes\": " << layer.memoryBytes
+            << ", \"wall_ms\": " << layer.endMs - layer.startMs;
+        for(int p = 0; p < PHASE_COUNT; ++p){
+            out << ", \"" << PHASE_NAMES[p] << "_ms\": " << layer.phaseNs[p] / 1e6;
+        }
+        out << "}" << (i + 1 < m_layers.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void SearchStats::writeChromeTrace(std::ostream &out) const
+{
+    out << "{\"traceEvents\": [\n";
+    bool first = true;
+    for(const Layer &layer : m_layers){
+        out << (first ? "" : ",\n");
+        first = false;
+        out << "  {\"name\": \"layer " << layer.depth << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+            << ", \"ts\": " << layer.startMs * 1000 << ", \"dur\": " << (layer.endMs - layer.startMs) * 1000
+            << ", \"args\": {\"frontier\": " << layer.frontier << ", \"expanded\": " << layer.expanded
+            << ", \"generated\": " << layer.generated << ", \"added\": " << layer.added
+            << ", \"memory_bytes\": " << layer.memoryBytes << "}}";
+
+        // The phases of a layer are drawn one after the other inside the layer
+        double phaseStart = layer.startMs * 1000;
+        for(int p = 0; p < PHASE_COUNT; ++p){
+            double duration = layer.phaseNs[p] / 1e3;
+            out << ",\n  {\"name\": \"" << PHASE_NAMES[p] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": 2"
+                << ", \"ts\": " << phaseStart << ", \"dur\": " << duration << "}";
+            phaseStart += duration;
+        }
+        out << ",\n  {\"name\": \"frontier\", \"ph\": \"C\", \"pid\": 1, \"ts\": " << layer.startMs * 1000
+            << ", \"args\": {\"states\": " << layer.frontier << "}}";
+        out << ",\n  {\"name\": \"memory\", \"ph\": \"C\", \"pid\": 1, \"ts\": " << layer.endMs * 1000
+            << ", \"args\": {\"bytes\": " << layer.memoryBytes << "}}";
+    }
+    out << "\n]}\n";
+}
@@ -0,0 +1,190 @@
+#ifndef SEARCHSTATS_HPP
+#define SEARCHSTATS_HPP
+
+#include <vector>
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief The Phase enum the parts of the hot path whose time is measured
+ */
+enum Phase {
+    MOVE_GENERATION,
+    BOARD_PAINTING,
+    SERIALIZATION,
+    VISITED_LOOKUP,
+    PHASE_COUNT
+};
+
+/**
+ * @brief The SearchStats class counters filled during a search :
+ * time spent in each phase of the hot path, probe lengths of the
+ * visited set, and per-layer figures (frontier size, branching
+ * factor, memory).
+ * The counters are only filled on the thread where the stats are
+ * active, and only if the program is built with RUSHHOUR_STATS,
+ * otherwise the probes of the hot path compile to nothing
+ */
+class SearchStats
+{
+public:
+    /**
+     * @brief The Layer struct the figures of a layer of the search
+     * (a depth for the breadth-first searches, a bound for A* and IDA*)
+     */
+    struct Layer{
+        int depth;
+        size_t frontier;
+        size_t expanded;
+        size_t generated;
+        size_t added;
+        size_t memoryBytes;
+        double startMs;
+        double endMs;
+        std::array<uint64_t, PHASE_COUNT> phaseNs;
+    };
+
+    /**
+     * @brief MAX_PROBE probe lengths above this value share the last histogram entry
+     */
+    static const int MAX_PROBE = 16;
+
+    /**
+     * @brief SearchStats constructor, for inactive stats
+     */
+    SearchStats();
+
+    /**
+     * @brief current the stats active on this thread
+     * @return the active stats, nullptr if none (or if built without RUSHHOUR_STATS)
+     */
+    static SearchStats *current();
+
+    /**
+     * @brief activate makes these stats the active ones on this thread
+     */
+    void activate();
+
+    /**
+     * @brief deactivate stops filling these stats
+     */
+    void deactivate();
+
+    /**
+     * @brief addTime adds time spent in a phase
+     * @param phase the phase
+     * @param nanoseconds the time spent
+     */
+    void addTime(Phase phase, uint64_t nanoseconds);
+
+    /**
+     * @brief recordProbe counts a lookup in the visited set
+     * @param length the number of slots read by the lookup
+     */
+    void recordProbe(int length);
+
+    /**
+     * @brief addGenerated counts states generated by an expansion
+     * (including the already visited ones)
+     * @param count the number of states generated
+     */
+    void addGenerated(size_t count);
+
+    /**
+     * @brief absorb adds the counters filled by another thread (phase times,
+     * probes and states generated) to these stats, and empties them there.
+     * The phase times of several threads add up, they are then CPU times
+     * @param other the stats of the other thread
+     */
+    void absorb(SearchStats &other);
+
+    /**
+     * @brief beginLayer starts a new layer, ending the previous one
+     * @param depth the depth (or bound) of the layer
+     * @param frontier the number of states waiting to be expanded
+     */
+    void beginLayer(int depth, size_t frontier);
+
+    /**
+     * @brief endLayer ends the current layer
+     * @param expanded the number of states expanded in the layer
+     * @param added the number of new states found by the layer
+     * @param memoryBytes the memory used by the search at the end of the layer
+     */
+    void endLayer(size_t expanded, size_t added, size_t memoryBytes);
+
+    /**
+     * @brief writeJson writes all the counters as a JSON object
+     * @param out the stream to write to
+     */
+    void writeJson(std::ostream &out) const;
+
+    /**
+     * @brief writeChromeTrace writes the layers and their phases as a
+     * trace readable by chrome://tracing or Perfetto
+     * @param out the stream to write to
+     */
+    void writeChromeTrace(std::ostream &out) const;
+
+private:
+    /**
+     * @brief elapsedMs time since the stats were activated
+     * @return the time in milliseconds
+     */
+    double elapsedMs() const;
+
+    std::chrono::steady_clock::time_point m_origin;
+    std::array<uint64_t, PHASE_COUNT> m_phaseNs;
+    std::array<uint64_t, MAX_PROBE + 1> m_probeHistogram;
+    uint64_t m_lookups;
+    uint64_t m_probes;
+    uint64_t m_generated;
+    std::vector<Layer> m_layers;
+    bool m_layerOpen;
+    uint64_t m_layerGenerated;
+};
+
+/**
+ * @brief The ScopedPhase class measures the time spent in a phase
+ * until the end of the scope, if stats are active on this thread
+ */
+class ScopedPhase
+{
+public:
+    explicit ScopedPhase(Phase phase):
+        m_stats(SearchStats::current()),
+        m_phase(phase)
+    {
+        if(m_stats) m_start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedPhase()
+    {
+        if(m_stats){
+            auto elapsed = std::chrono::steady_clock::now() - m_start;
+            m_stats->addTime(m_phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+private:
+    SearchStats *m_stats;
+    Phase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#ifdef RUSHHOUR_STATS
+#define RUSHHOUR_STATS_PHASE(phase) ScopedPhase rushhourStatsPhase(phase)
+#define RUSHHOUR_STATS_PROBE(length) \
+    do { if(SearchStats *rushhourStats = SearchStats::current()) rushhourStats->recordProbe(length); } while(0)
+#define RUSHHOUR_STATS_GENERATED(count) \
+    do { if(SearchStats *rushhourStats = SearchStats::current()) rushhourStats->addGenerated(count); } while(0)
+#else
+#define RUSHHOUR_STATS_PHASE(phase) do {} while(0)
+#define RUSHHOUR_STATS_PROBE(length) do { (void)(length); } while(0)
+#define RUSHHOUR_STATS_GENERATED(count) do { (void)(count); } while(0)
+#endif
+
+#endif // SEARCHSTATS_HPP
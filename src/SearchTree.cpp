@@ -0,0 +1,146 @@
+#include "SearchTree.hpp"
+#include "SearchStats.hpp"
+
+#include <algorithm>
+
+SearchTree::SearchTree(size_t initialCapacity):
+    m_keys(),
+    m_parents(),
+    m_moves(),
+    m_index()
+{
+    m_keys.reserve(initialCapacity);
+    m_parents.reserve(initialCapacity);
+    m_moves.reserve(initialCapacity);
+    size_t capacity = 16;
+    while(capacity < initialCapacity * 2) capacity <<= 1;
+    m_index.resize(capacity, 0);
+}
+
+bool SearchTree::insert(StateKey key, int32_t parent, const Move &move)
+{
+    RUSHHOUR_STATS_PHASE(VISITED_LOOKUP);
+    if((m_keys.size() + 1) * 2 > m_index.size()) grow();
+
+    size_t mask = m_index.size() - 1;
+    size_t slot = hashKey(key) & mask;
+    int probes = 1;
+    while(m_index[slot]){
+        if(m_keys[m_index[slot] - 1] == key){
+            RUSHHOUR_STATS_PROBE(probes);
+            return false;
+        }
+        slot = (slot + 1) & mask;
+        probes++;
+    }
+    RUSHHOUR_STATS_PROBE(probes);
+    m_keys.push_back(key);
+    m_parents.push_back(parent);
+    m_moves.push_back(move.toCode());
+    m_index[slot] = static_cast<uint32_t>(m_keys.size());
+    return true;
+}
+
+size_t SearchTree::extend(size_t count)
+{
+    size_t first = m_keys.size();
+    while((first + count) * 2 > m_index.size()) grow();
+    m_keys.resize(first + count);
+    m_parents.resize(first + count);
+    m_moves.resize(first + count);
+    return first;
+}
+
+void SearchTree::place(size_t node, StateKey key, int32_t parent, const Move &move)
+{
+    RUSHHOUR_STATS_PHASE(VISITED_LOOKUP);
+    m_keys[node] = key;
+    m_parents[node] = parent;
+    m_moves[node] = move.toCode();
+
+    // The key is not in the tree, the first empty slot of its cluster is taken
+    size_t mask = m_index.size() - 1;
+    size_t slot = hashKey(key) & mask;
+    uint32_t value = static_cast<uint32_t>(node + 1);
+    uint32_t empty = 0;
+    while(!__atomic_compare_exchange_n(&m_index[slot], &empty, value, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+        empty = 0;
+        slot = (slot + 1) & mask;
+    }
+}
+
+bool SearchTree::contains(StateKey key) const
+{
+    size_t mask = m_index.size() - 1;
+    size_t slot = hashKey(key) & mask;
+    int probes = 1;
+    while(m_index[slot]){
+        if(m_keys[m_index[slot] - 1] == key){
+            RUSHHOUR_STATS_PROBE(probes);
+            return true;
+        }
+        slot = (slot + 1) & mask;
+        probes++;
+    }
+    RUSHHOUR_STATS_PROBE(probes);
+    return false;
+}
+
+void SearchTree::clear()
+{
+    if(m_keys.size() * 8 < m_index.size()){
+        // Each node is after the slot of its hash, in the same cluster
+        size_t mask = m_index.size() - 1;
+        for(size_t node = 0; node < m_keys.size(); ++node){
+            size_t slot = hashKey(m_keys[node]) & mask;
+            while(m_index[slot] != node + 1) slot = (slot + 1) & mask;
+            m_index[slot] = 0;
+        }
+    } else {
+        std::fill(m_index.begin(), m_index.end(), 0);
+    }
+    m_keys.clear();
+    m_parents.clear();
+    m_moves.clear();
+}
+
+size_t SearchTree::size() const
+{
+    return m_keys.size();
+}
+
+std::vector<State> SearchTree::path(const State &start, size_t node) const
+{
+    std::vector<uint16_t> moves;
+    for(int32_t i = static_cast<int32_t>(node); m_parents[i] != NO_PARENT; i = m_parents[i]){
+        moves.push_back(m_moves[i]);
+    }
+    std::reverse(moves.begin(), moves.end());
+
+    std::vector<State> states(1, start);
+    for(uint16_t move : moves){
+        State next = states.back();
+        next.play(Move::fromCode(move));
+        states.push_back(next);
+    }
+    return states;
+}
+
+size_t SearchTree::memoryBytes() const
+{
+    return m_keys.capacity() * sizeof(StateKey) + m_parents.capacity() * sizeof(int32_t) +
+            m_moves.capacity() * sizeof(uint16_t) + m_index.capacity() * sizeof(uint32_t);
+}
+
+void SearchTree::grow()
+{
+    std::vector<uint32_t> old(m_index.size() * 2, 0);
+    old.swap(m_index);
+    size_t mask = m_index.size() - 1;
+    for(uint32_t node : old){
+        if(!node) continue;
+        size_t slot = hashKey(m_keys[node - 1]) & mask;
+        while(m_index[slot]) slot = (slot + 1) & mask;
+        m_index[slot] = node;
+    }
+}
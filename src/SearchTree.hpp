@@ -0,0 +1,148 @@
+#ifndef SEARCHTREE_HPP
+#define SEARCHTREE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "StateKey.hpp"
+#include "State.hpp"
+
+/**
+ * @brief The SearchTree class the states reached by a search, in the
+ * order they were found, each stored as its packed key, the index of
+ * its parent and the move played from the parent (two bytes).
+ * The states reached are also indexed in an open addressing table of
+ * 32 bits node indexes, used to skip the states already in the tree :
+ * a node takes about 30 bytes, against a whole State, its parent and
+ * a slot of a StateSet otherwise. Full states are only rebuilt from
+ * their keys while expanding them, and for the final path
+ */
+class SearchTree
+{
+public:
+    /**
+     * @brief NO_PARENT the parent of the root of the tree
+     */
+    static const int32_t NO_PARENT = -1;
+
+    /**
+     * @brief SearchTree constructor for an empty tree
+     * @param initialCapacity the number of nodes to reserve space for
+     */
+    explicit SearchTree(size_t initialCapacity = 1024);
+
+    /**
+     * @brief insert adds a node, if its state is not already in the tree
+     * @param key the packed state of the node
+     * @param parent the index of the node it was reached from (NO_PARENT for the root)
+     * @param move the move played from the parent
+     * @return wether the node was added
+     */
+    bool insert(StateKey key, int32_t parent, const Move &move);
+
+    /**
+     * @brief extend adds empty nodes at the end of the tree, to be filled
+     * by place, the index is grown first so that they all fit in it
+     * @param count the number of nodes to add
+     * @return the index of the first node added
+     */
+    size_t extend(size_t count);
+
+    /**
+     * @brief place fills a node added by extend and indexes it. Several
+     * threads can place nodes at the same time, the slots of the index
+     * being taken with an atomic compare and swap : the keys placed must be
+     * different from each other and from the keys already in the tree
+     * @param node the index of the node
+     * @param key the packed state of the node
+     * @param parent the index of the node it was reached from
+     * @param move the move played from the parent
+     */
+    void place(size_t node, StateKey key, int32_t parent, const Move &move);
+
+    /**
+     * @brief contains wether the state is already in the tree,
+     * several threads can call it as long as none is inserting
+     * @param key the packed state
+     * @return wether a node has this state
+     */
+    bool contains(StateKey key) const;
+
+    /**
+     * @brief key the packed state of a node
+     * @param node the index of the node
+     * @return the packed state
+     */
+    StateKey key(size_t node) const
+    {
+        return m_keys[node];
+    }
+
+    /**
+     * @brief parent the node a node was reached from, the parent
+     * of a node always comes before it
+     * @param node the index of the node
+     * @return the index of its parent, NO_PARENT for the root
+     */
+    int32_t parent(size_t node) const
+    {
+        return m_parents[node];
+    }
+
+    /**
+     * @brief clear removes all the nodes, but keeps the memory, so
+     * that the tree can be reused by another search without allocating,
+     * only the used slots of the index are emptied when there are few of them
+     */
+    void clear();
+
+    /**
+     * @brief size number of nodes of the tree
+     * @return the number of nodes
+     */
+    size_t size() const;
+
+    /**
+     * @brief path rebuilds the states from the root to a node,
+     * by playing the moves of the nodes from the starting state
+     * @param start the state of the root
+     * @param node the index of the last node of the path
+     * @return the states of the path, the starting state first
+     */
+    std::vector<State> path(const State &start, size_t node) const;
+
+    /**
+     * @brief memoryBytes memory used by the nodes and their index
+     * @return the number of bytes
+     */
+    size_t memoryBytes() const;
+
+private:
+    /**
+     * @brief grow doubles the number of slots of the index
+     */
+    void grow();
+
+    /**
+     * @brief m_keys the packed state of every node
+     */
+    std::vector<StateKey> m_keys;
+
+    /**
+     * @brief m_parents the index of the parent of every node
+     */
+    std::vector<int32_t> m_parents;
+
+    /**
+     * @brief m_moves the move reaching every node, see Move::toCode
+     */
+    std::vector<uint16_t> m_moves;
+
+    /**
+     * @brief m_index the slots of the table, the index of
+     * a node plus one, 0 for an empty slot
+     */
+    std::vector<uint32_t> m_index;
+};
+
+#endif // SEARCHTREE_HPP
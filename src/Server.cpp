@@ -0,0 +1,166 @@
+#include "Server.hpp"
+#include "Batch.hpp"
+#include "Map.hpp"
+
+#include <array>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <streambuf>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief The SocketBuffer class a stream buffer reading
+ * and writing a connected socket, through fixed buffers
+ */
+class SocketBuffer : public std::streambuf
+{
+public:
+    /**
+     * @brief SocketBuffer constructor
+     * @param socket the connected socket, not closed by the buffer
+     */
+    explicit SocketBuffer(int socket):
+        m_socket(socket),
+        m_input(),
+        m_output()
+    {
+        setg(m_input.data(), m_input.data(), m_input.data());
+        setp(m_output.data(), m_output.data() + m_output.size());
+    }
+
+protected:
+    int_type underflow() override
+    {
+        ssize_t count;
+        do{
+            count = recv(m_socket, m_input.data(), m_input.size(), 0);
+        } while(count < 0 && errno == EINTR);
+        if(count <= 0) return traits_type::eof();
+        setg(m_input.data(), m_input.data(), m_input.data() + count);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if(sync() != 0) return traits_type::eof();
+        if(!traits_type::eq_int_type(c, traits_type::eof())){
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override
+    {
+        const char *data = pbase();
+        while(data < pptr()){
+            // A client leaving early must not kill the server with SIGPIPE
+            ssize_t count = send(m_socket, data, pptr() - data, MSG_NOSIGNAL);
+            if(count < 0 && errno == EINTR) continue;
+            if(count <= 0) return -1;
+            data += count;
+        }
+        setp(m_output.data(), m_output.data() + m_output.size());
+        return 0;
+    }
+
+private:
+    int m_socket;
+    std::array<char, 4096> m_input;
+    std::array<char, 4096> m_output;
+};
+
+/**
+ * @brief skipPuzzle skips the lines of a malformed puzzle, up to the next blank line
+ * @param in the stream of puzzles
+ */
+void skipPuzzle(std::istream &in)
+{
+    in.clear();
+    std::string line;
+    while(std::getline(in, line)){
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        if(line.empty()) break;
+    }
+}
+
+}
+
+PuzzleServer::PuzzleServer(const SolverOptions &options):
+    m_solver(),
+    m_options(options),
+    m_requests(0)
+{
+
+}
+
+void PuzzleServer::serve(std::istream &in, std::ostream &out)
+{
+    while(in >> std::ws && in.peek() != std::istream::traits_type::eof()){
+        auto start = std::chrono::steady_clock::now();
+        BatchResult result;
+        // Only a puzzle that can't be read leaves lines to skip
+        Map map;
+        bool read = false;
+        try{
+            map = parseMap(in, "puzzle " + std::to_string(++m_requests));
+            read = true;
+            result = solveMap(map, m_solver, m_options);
+        } catch(const std::exception &e){
+            result.error = e.what();
+            if(!read) skipPuzzle(in);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        result.seconds = elapsed.count();
+        writeResult(out, result, JSON_LINES);
+        out.flush();
+        if(!out) break;
+    }
+}
+
+void serveSocket(const std::string &path, int threadCount, const SolverOptions &options)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(address.sun_path)) throw std::runtime_error("The socket path is too long " + path);
+    std::strcpy(address.sun_path, path.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0) throw std::runtime_error("Can't create the socket " + path);
+    unlink(path.c_str());
+    if(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, 64) < 0){
+        close(listener);
+        throw std::runtime_error("Can't listen on " + path + " : " + std::strerror(errno));
+    }
+
+    std::vector<std::thread> workers;
+    for(int i = 0; i < std::max(1, threadCount); ++i){
+        workers.emplace_back([listener, &options](){
+            PuzzleServer server(options);
+            while(true){
+                int client = accept(listener, nullptr, nullptr);
+                if(client < 0){
+                    if(errno == EINTR || errno == ECONNABORTED) continue;
+                    break;
+                }
+                SocketBuffer buffer(client);
+                std::istream in(&buffer);
+                std::ostream out(&buffer);
+                server.serve(in, out);
+                close(client);
+            }
+        });
+    }
+    for(std::thread &worker : workers) worker.join();
+    close(listener);
+}
@@ -0,0 +1,63 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <string>
+#include <istream>
+#include <ostream>
+#include "Solver.hpp"
+
+/**
+ * @brief The PuzzleServer class answers the puzzles read from a stream,
+ * one after the other, as long as the process lives, with the same Solver :
+ * its memory is reused between the puzzles instead of being freed, so once the
+ * first puzzles have been solved, a puzzle only costs its search
+ */
+class PuzzleServer
+{
+public:
+    /**
+     * @brief PuzzleServer constructor
+     * @param options how to solve every puzzle
+     */
+    explicit PuzzleServer(const SolverOptions &options = SolverOptions());
+
+    /**
+     * @brief serve reads puzzles written as in the puzzle files, and answers
+     * every one with a line of JSON (as the batch mode, without the file),
+     * until the end of the stream. The puzzles can be separated by blank
+     * lines, after a malformed puzzle the lines are skipped up to the next blank one
+     * @param in the stream of puzzles
+     * @param out the stream of answers, flushed after every answer
+     */
+    void serve(std::istream &in, std::ostream &out);
+
+private:
+    /**
+     * @brief m_solver the solver of all the puzzles
+     */
+    Solver m_solver;
+
+    /**
+     * @brief m_options how to solve every puzzle
+     */
+    SolverOptions m_options;
+
+    /**
+     * @brief m_requests number of puzzles read, to name them in the errors
+     */
+    size_t m_requests;
+};
+
+/**
+ * @brief serveSocket listens on a Unix domain socket, every connection
+ * being served as a stream of puzzles by PuzzleServer::serve. Each worker
+ * thread accepts the connections with its own PuzzleServer, so the
+ * threads and their memory are kept from one connection to the other.
+ * Only returns if the socket fails, throws an exception if it can't be created
+ * @param path the path of the socket, an existing file there is replaced
+ * @param threadCount the number of connections served at the same time
+ * @param options how to solve every puzzle
+ */
+void serveSocket(const std::string &path, int threadCount, const SolverOptions &options = SolverOptions());
+
+#endif // SERVER_HPP
@@ -0,0 +1,187 @@
+#include "SolutionDatabase.hpp"
+#include "DistanceTable.hpp"
+#include "Map.hpp"
+
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief MAGIC identifies the file format and its version
+ */
+const char MAGIC[8] = {'R', 'H', 'D', 'B', '0', '0', '0', '2'};
+
+/**
+ * @brief KEYS_PER_BLOCK number of keys between two fences, a block fills a page
+ */
+const size_t KEYS_PER_BLOCK = 4096 / sizeof(StateKey);
+
+/**
+ * @brief align rounds the offset up to the next multiple of the page size
+ * @param offset the offset to align
+ * @return the aligned offset
+ */
+uint64_t align(uint64_t offset)
+{
+    return (offset + 4095) & ~uint64_t(4095);
+}
+
+/**
+ * @brief fits wether a region of the file ends before a limit
+ * @param offset where the region starts
+ * @param count the number of items of the region
+ * @param itemSize the size of an item
+ * @param limit where the region must end at the latest
+ * @return false if the region goes past the limit
+ */
+bool fits(uint64_t offset, uint64_t count, uint64_t itemSize, uint64_t limit)
+{
+    return offset <= limit && count <= (limit - offset) / itemSize;
+}
+
+}
+
+SolutionDatabase::SolutionDatabase():
+    m_data(nullptr),
+    m_size(0),
+    m_header(nullptr)
+{
+
+}
+
+SolutionDatabase::~SolutionDatabase()
+{
+    close();
+}
+
+void SolutionDatabase::write(const std::string &path, Map &map, const DistanceTable &table)
+{
+    const std::vector<StateKey> &keys = table.keys();
+    const std::vector<uint8_t> &distances = table.distances();
+
+    std::vector<StateKey> fences;
+    for(size_t i = 0; i < keys.size(); i += KEYS_PER_BLOCK) fences.push_back(keys[i]);
+
+    std::vector<DatabaseEntry> entries(keys.size());
+    for(size_t i = 0; i < keys.size(); ++i){
+        DatabaseEntry &entry = entries[i];
+        entry.distance = distances[i];
+        entry.car = NO_MOVE;
+        entry.move = 0;
+        entry.padding = 0;
+        Move move;
+        if(table.bestMove(map, State::fromKey(keys[i], map.encoder()), move)){
+            entry.car = static_cast<uint8_t>(move.car);
+            entry.move = move.distance;
+        }
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.count = keys.size();
+    header.fingerprint = map.fingerprint();
+    header.fenceCount = fences.size();
+    header.fencesOffset = align(sizeof(Header));
+    header.keysOffset = align(header.fencesOffset + fences.size() * sizeof(StateKey));
+    header.entriesOffset = align(header.keysOffset + keys.size() * sizeof(StateKey));
+    header.fileSize = header.entriesOffset + entries.size() * sizeof(DatabaseEntry);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()) throw std::runtime_error("Can't create the database " + path);
+    auto writeAt = [&file](uint64_t offset, const void *data, size_t size){
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    };
+    // Write the header last : a partially written file is never valid
+    std::vector<char> blank(header.fencesOffset, 0);
+    writeAt(0, blank.data(), blank.size());
+    writeAt(header.fencesOffset, fences.data(), fences.size() * sizeof(StateKey));
+    writeAt(header.keysOffset, keys.data(), keys.size() * sizeof(StateKey));
+    writeAt(header.entriesOffset, entries.data(), entries.size() * sizeof(DatabaseEntry));
+    writeAt(0, &header, sizeof(header));
+    if(!file) throw std::runtime_error("Can't write the database " + path);
+}
+
+bool SolutionDatabase::open(const std::string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+    struct stat info;
+    if(fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)){
+        ::close(fd);
+        return false;
+    }
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(data == MAP_FAILED) return false;
+
+    m_data = static_cast<const char *>(data);
+    m_size = info.st_size;
+    m_header = reinterpret_cast<const Header *>(m_data);
+    if(std::memcmp(m_header->magic, MAGIC, sizeof(MAGIC)) != 0 || m_header->fileSize > m_size){
+        close();
+        return false;
+    }
+
+    // The fences, the keys and the entries follow each other inside the file,
+    // aligned for their type, with a fence for every block of keys
+    const Header &header = *m_header;
+    bool aligned = header.fencesOffset % alignof(StateKey) == 0 && header.keysOffset % alignof(StateKey) == 0 &&
+            header.entriesOffset % alignof(DatabaseEntry) == 0;
+    if(!aligned || header.fencesOffset < sizeof(Header) ||
+       header.fenceCount != (header.count + KEYS_PER_BLOCK - 1) / KEYS_PER_BLOCK ||
+       !fits(header.fencesOffset, header.fenceCount, sizeof(StateKey), header.keysOffset) ||
+       !fits(header.keysOffset, header.count, sizeof(StateKey), header.entriesOffset) ||
+       !fits(header.entriesOffset, header.count, sizeof(DatabaseEntry), header.fileSize)){
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SolutionDatabase::close()
+{
+    if(m_data) munmap(const_cast<char *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+}
+
+bool SolutionDatabase::lookup(StateKey key, DatabaseEntry &entry) const
+{
+    if(!m_header || m_header->count == 0) return false;
+    const StateKey *fences = reinterpret_cast<const StateKey *>(m_data + m_header->fencesOffset);
+    const StateKey *keys = reinterpret_cast<const StateKey *>(m_data + m_header->keysOffset);
+    const DatabaseEntry *entries = reinterpret_cast<const DatabaseEntry *>(m_data + m_header->entriesOffset);
+
+    // The last fence not greater than the key gives the block to search
+    const StateKey *fence = std::upper_bound(fences, fences + m_header->fenceCount, key);
+    if(fence == fences) return false;
+    size_t first = (fence - fences - 1) * KEYS_PER_BLOCK;
+    size_t last = std::min<size_t>(first + KEYS_PER_BLOCK, m_header->count);
+
+    const StateKey *found = std::lower_bound(keys + first, keys + last, key);
+    if(found == keys + last || *found != key) return false;
+    entry = entries[found - keys];
+    return true;
+}
+
+size_t SolutionDatabase::size() const
+{
+    return m_header ? m_header->count : 0;
+}
+
+uint64_t SolutionDatabase::fingerprint() const
+{
+    return m_header ? m_header->fingerprint : 0;
+}
@@ -0,0 +1,143 @@
+#ifndef SOLUTIONDATABASE_HPP
+#define SOLUTIONDATABASE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "StateKey.hpp"
+
+class Map;
+class DistanceTable;
+
+/**
+ * @brief The DatabaseEntry struct what the database knows about a state
+ */
+struct DatabaseEntry{
+    /**
+     * @brief distance number of moves needed to solve the state,
+     * DistanceTable::NO_SOLUTION if the state can't be solved
+     */
+    uint8_t distance;
+
+    /**
+     * @brief car index of the car to move (0 for the main car),
+     * NO_MOVE for the solved states and the states without solution
+     */
+    uint8_t car;
+
+    /**
+     * @brief move the distance the car must slide
+     */
+    int8_t move;
+
+    /**
+     * @brief padding unused, keeps the entries on 4 bytes
+     */
+    uint8_t padding;
+};
+
+/**
+ * @brief The SolutionDatabase class a file storing the distance
+ * and the best move of every state of a cluster, made to be
+ * memory-mapped and queried without any parsing.
+ * The file contains :
+ *  - a header (format version, number of states, map fingerprint)
+ *  - the fences : the first key of every block of keys
+ *  - the keys, sorted, in blocks of one page
+ *  - the entries, in the same order as the keys
+ * Opening the file only reads the header, a lookup searches the
+ * fences, then a single block of keys, then reads a single entry,
+ * so it only touches a few pages whatever the size of the database
+ * The integers are stored with the byte order of the machine
+ */
+class SolutionDatabase
+{
+public:
+    /**
+     * @brief NO_MOVE car index of the entries without best move
+     */
+    static constexpr uint8_t NO_MOVE = 0xff;
+
+    /**
+     * @brief SolutionDatabase empty constructor, for a closed database
+     */
+    SolutionDatabase();
+
+    ~SolutionDatabase();
+
+    SolutionDatabase(const SolutionDatabase &) = delete;
+    SolutionDatabase &operator=(const SolutionDatabase &) = delete;
+
+    /**
+     * @brief write builds the database of a cluster and saves it
+     * throws an exception if the file can't be written
+     * @param path the file to create
+     * @param map the map of the cluster, used as the working board
+     * @param table the distances of the cluster
+     */
+    static void write(const std::string &path, Map &map, const DistanceTable &table);
+
+    /**
+     * @brief open maps the given file in memory
+     * @param path the database file
+     * @return false if the file can't be opened or is not a valid database
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief close unmaps the file
+     */
+    void close();
+
+    /**
+     * @brief lookup finds the entry of a state
+     * @param key the packed state
+     * @param entry the entry found
+     * @return wether the state is in the database
+     */
+    bool lookup(StateKey key, DatabaseEntry &entry) const;
+
+    /**
+     * @brief size number of states in the database
+     * @return the number of states
+     */
+    size_t size() const;
+
+    /**
+     * @brief fingerprint fingerprint of the map the database was built for
+     * @return the fingerprint given by Map::fingerprint
+     */
+    uint64_t fingerprint() const;
+
+private:
+    /**
+     * @brief The Header struct the beginning of the file
+     */
+    struct Header{
+        char magic[8];
+        uint64_t count;
+        uint64_t fingerprint;
+        uint64_t fenceCount;
+        uint64_t fencesOffset;
+        uint64_t keysOffset;
+        uint64_t entriesOffset;
+        uint64_t fileSize;
+    };
+
+    /**
+     * @brief m_data the mapped file, nullptr when closed
+     */
+    const char *m_data;
+
+    /**
+     * @brief m_size size of the mapped file
+     */
+    size_t m_size;
+
+    /**
+     * @brief m_header the header of the mapped file
+     */
+    const Header *m_header;
+};
+
+#endif // SOLUTIONDATABASE_HPP
@@ -0,0 +1,147 @@
+#include "Solver.hpp"
+#include "Search.hpp"
+#include "FixedSearch.hpp"
+#include "FrontierSearch.hpp"
+#include "RankedSearch.hpp"
+#include "ExternalSearch.hpp"
+#include "ThreadPool.hpp"
+#include "TranspositionTable.hpp"
+
+#include <chrono>
+#include <algorithm>
+
+SolverOptions::SolverOptions():
+    algorithm(BREADTH_FIRST),
+    threadCount(1),
+    heuristic(BLOCKERS_OF_BLOCKERS),
+    memoryMegabytes(256),
+    tableMegabytes(64),
+    externalDirectory(),
+    recordStats(false)
+{
+
+}
+
+SolverResult::SolverResult():
+    found(false),
+    depth(-1),
+    moves(),
+    path(),
+    explored(0),
+    seconds(0),
+    algorithm(BREADTH_FIRST),
+    stats()
+{
+
+}
+
+Solver::Solver():
+    m_tree(100000),
+    m_aStar(),
+    m_depths(),
+    m_pool(),
+    m_table(),
+    m_tableMegabytes(0),
+    m_board()
+{
+
+}
+
+Solver::~Solver()
+{
+
+}
+
+SolverResult Solver::solve(const Map &map, const SolverOptions &options)
+{
+    m_board = map;
+    State start;
+    start.extractFrom(m_board);
+    return run(start, options);
+}
+
+SolverResult Solver::solve(const Map &board, const State &start, const SolverOptions &options)
+{
+    m_board = board;
+    return run(start, options);
+}
+
+SolverResult Solver::run(const State &start, const SolverOptions &options)
+{
+    SolverResult result;
+    if(options.recordStats) result.stats.activate();
+    auto begin = std::chrono::steady_clock::now();
+    search(start, options, result);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    result.stats.deactivate();
+
+    result.seconds = elapsed.count();
+    if(result.found){
+        result.depth = static_cast<int>(result.path.size()) - 1;
+        for(size_t i = 1; i < result.path.size(); ++i){
+            result.moves.push_back(result.path[i - 1].moveTo(result.path[i]));
+        }
+    }
+    return result;
+}
+
+Map &Solver::board()
+{
+    return m_board;
+}
+
+const SearchTree &Solver::tree() const
+{
+    return m_tree;
+}
+
+void Solver::search(const State &start, const SolverOptions &options, SolverResult &result)
+{
+    SearchResult search;
+    result.algorithm = options.algorithm;
+    switch(options.algorithm){
+    case GENERIC_BREADTH_FIRST:
+        search = breadthFirstSearch(m_board, start, m_tree);
+        break;
+    case PARALLEL_BREADTH_FIRST:
+        if(!m_pool || m_pool->size() != std::max(1, options.threadCount)){
+            m_pool.reset();
+            m_pool.reset(new ThreadPool(std::max(1, options.threadCount)));
+        }
+        search = parallelBreadthFirstSearch(m_board, start, *m_pool, m_tree);
+        break;
+    case FRONTIER:
+        search = frontierBreadthFirstSearch(m_board, start);
+        break;
+    case RANKED:{
+        size_t bytes = rankedSearchBytes(m_board);
+        if(bytes && bytes <= options.memoryMegabytes * 1024 * 1024){
+            search = rankedBreadthFirstSearch(m_board, start, m_depths);
+        } else {
+            result.algorithm = BREADTH_FIRST;
+            search = specializedBreadthFirstSearch(m_board, start, m_tree);
+        }
+        break;
+    }
+    case EXTERNAL:
+        search = externalBreadthFirstSearch(m_board, start, options.externalDirectory, options.memoryMegabytes);
+        break;
+    case A_STAR:
+        search = aStarSearch(m_board, start, options.heuristic, m_aStar);
+        break;
+    case IDA_STAR:
+        if(!m_table || m_tableMegabytes != options.tableMegabytes){
+            m_table.reset();
+            m_table.reset(new TranspositionTable(options.tableMegabytes));
+            m_tableMegabytes = options.tableMegabytes;
+        }
+        search = idaStarSearch(m_board, start, options.heuristic, *m_table);
+        break;
+    default:
+        search = specializedBreadthFirstSearch(m_board, start, m_tree);
+        break;
+    }
+    result.found = search.found;
+    result.path.swap(search.path);
+    result.explored = search.explored;
+}
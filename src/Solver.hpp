@@ -0,0 +1,273 @@
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "Map.hpp"
+#include "State.hpp"
+#include "Heuristic.hpp"
+#include "SearchTree.hpp"
+#include "SearchStats.hpp"
+#include "Search.hpp"
+
+class ThreadPool;
+class TranspositionTable;
+
+/**
+ * @brief The SearchAlgorithm enum the searches a Solver can run
+ */
+enum SearchAlgorithm {
+    /**
+     * @brief BREADTH_FIRST the breadth-first search compiled for the
+     * size of the map when there is one, the generic one otherwise
+     */
+    BREADTH_FIRST,
+    /**
+     * @brief GENERIC_BREADTH_FIRST the breadth-first search working with any size
+     */
+    GENERIC_BREADTH_FIRST,
+    /**
+     * @brief PARALLEL_BREADTH_FIRST the breadth-first search split between threads
+     */
+    PARALLEL_BREADTH_FIRST,
+    /**
+     * @brief FRONTIER the breadth-first search only keeping its last layers
+     */
+    FRONTIER,
+    /**
+     * @brief RANKED the breadth-first search over the ranks of the states
+     */
+    RANKED,
+    /**
+     * @brief EXTERNAL the breadth-first search keeping its layers on disk
+     */
+    EXTERNAL,
+    /**
+     * @brief A_STAR the A* search
+     */
+    A_STAR,
+    /**
+     * @brief IDA_STAR the iterative deepening A* search
+     */
+    IDA_STAR
+};
+
+/**
+ * @brief The SolverOptions struct how a Solver solves a puzzle
+ */
+struct SolverOptions{
+
+    /**
+     * @brief SolverOptions constructor, for the breadth-first search
+     * compiled for the size of the map, without statistics
+     */
+    SolverOptions();
+
+    /**
+     * @brief algorithm the search to run
+     */
+    SearchAlgorithm algorithm;
+
+    /**
+     * @brief threadCount number of threads of PARALLEL_BREADTH_FIRST
+     */
+    int threadCount;
+
+    /**
+     * @brief heuristic the lower bound used by A_STAR and IDA_STAR
+     */
+    Heuristic heuristic;
+
+    /**
+     * @brief memoryMegabytes the memory RANKED and EXTERNAL can use
+     */
+    size_t memoryMegabytes;
+
+    /**
+     * @brief tableMegabytes the size of the transposition table of IDA_STAR
+     */
+    size_t tableMegabytes;
+
+    /**
+     * @brief externalDirectory where EXTERNAL writes its layers
+     */
+    std::string externalDirectory;
+
+    /**
+     * @brief recordStats wether the counters of the search are filled
+     * (they stay empty in a build without RUSHHOUR_STATS)
+     */
+    bool recordStats;
+};
+
+/**
+ * @brief The SolverResult struct what Solver::solve returns
+ */
+struct SolverResult{
+
+    /**
+     * @brief SolverResult constructor, for a puzzle without solution
+     */
+    SolverResult();
+
+    /**
+     * @brief found wether a solution was found
+     */
+    bool found;
+
+    /**
+     * @brief depth number of moves of the solution, -1 if no solution was found
+     */
+    int depth;
+
+    /**
+     * @brief moves the moves of the solution, the cars being
+     * numbered as in the states (0 is the main car)
+     */
+    std::vector<Move> moves;
+
+    /**
+     * @brief path all the states of the solution,
+     * from the starting state to the solved one
+     */
+    std::vector<State> path;
+
+    /**
+     * @brief explored number of states expanded by the search
+     */
+    size_t explored;
+
+    /**
+     * @brief seconds time spent by the search
+     */
+    double seconds;
+
+    /**
+     * @brief algorithm the search that was run, RANKED falls back to
+     * BREADTH_FIRST when its depths don't fit in memoryMegabytes
+     */
+    SearchAlgorithm algorithm;
+
+    /**
+     * @brief stats the counters of the search, empty unless recordStats was set
+     */
+    SearchStats stats;
+};
+
+/**
+ * @brief The Solver class solves puzzles, one after the other, keeping
+ * all the memory of a search : the tree of the states reached (which is
+ * the visited set and the queue of the breadth-first searches), the
+ * containers of A*, the depths of the ranked search, the threads of the
+ * parallel search and the transposition table of IDA* (both created by
+ * the first search needing them), and the board the states are placed on.
+ * Its memory is reused from one puzzle to the next, and nothing is shared
+ * between two solvers, so several threads can solve at the same time,
+ * each one with its own solver
+ */
+class Solver
+{
+public:
+    /**
+     * @brief Solver constructor
+     */
+    Solver();
+
+    /**
+     * @brief ~Solver stops the threads of the parallel search, if any
+     */
+    ~Solver();
+
+    /**
+     * @brief solve finds the shortest solution of a puzzle, throws an
+     * exception if the cars of the map can't be handled
+     * @param map the map of the puzzle, with its cars, as parseFile reads it
+     * @param options how to solve it
+     * @return the result of the search
+     */
+    SolverResult solve(const Map &map, const SolverOptions &options);
+
+    /**
+     * @brief solve as solve, for a puzzle whose cars are already
+     * extracted from the map, as PuzzlePack::puzzle reads it
+     * @param board the map of the puzzle, without its cars
+     * @param start the starting state
+     * @param options how to solve it
+     * @return the result of the search
+     */
+    SolverResult solve(const Map &board, const State &start, const SolverOptions &options);
+
+    /**
+     * @brief board the board of the last puzzle, without its cars,
+     * to place the states of the solution on
+     * @return the board
+     */
+    Map &board();
+
+    /**
+     * @brief tree the states kept by the last breadth-first search
+     * (BREADTH_FIRST, GENERIC_BREADTH_FIRST and PARALLEL_BREADTH_FIRST)
+     * @return the tree
+     */
+    const SearchTree &tree() const;
+
+private:
+    /**
+     * @brief search runs the search asked for on the board
+     * @param start the starting state
+     * @param options how to solve it
+     * @param result the result to fill with the search
+     */
+    void search(const State &start, const SolverOptions &options, SolverResult &result);
+
+    /**
+     * @brief run solves the puzzle placed in m_board, timing the search
+     * and recording its counters if asked to
+     * @param start the starting state
+     * @param options how to solve it
+     * @return the result of the search
+     */
+    SolverResult run(const State &start, const SolverOptions &options);
+
+    /**
+     * @brief m_tree the states of the last search, reused by the next one
+     */
+    SearchTree m_tree;
+
+    /**
+     * @brief m_aStar the containers of the last A* search
+     */
+    AStarMemory m_aStar;
+
+    /**
+     * @brief m_depths the depths of the last ranked search
+     */
+    std::vector<uint64_t> m_depths;
+
+    /**
+     * @brief m_pool the threads of the parallel search, created
+     * again when the number of threads asked for changes
+     */
+    std::unique_ptr<ThreadPool> m_pool;
+
+    /**
+     * @brief m_table the transposition table of IDA*, created
+     * again when the size asked for changes
+     */
+    std::unique_ptr<TranspositionTable> m_table;
+
+    /**
+     * @brief m_tableMegabytes the size m_table was created with
+     */
+    size_t m_tableMegabytes;
+
+    /**
+     * @brief m_board the map being solved, the states are placed on it
+     */
+    Map m_board;
+};
+
+#endif // SOLVER_HPP
@@ -5,128 +5,198 @@
 
 #include "State.hpp"
 #include "Map.hpp"
+#include "Bitboard.hpp"
+#include "SearchStats.hpp"
 
 #include <algorithm>
 #include <iostream>
-#include <sstream>
-#include <bitset>
-
-std::unordered_map<std::string, bool> State::knownStates = {};
 
 State::State():
-    m_mainCar(0,0)//Init with 'wrong' values
+    m_mainCar(0,0),//Init with 'wrong' values
+    m_cars(),
+    m_carCount(0)
 {
 
 }
 
-State::State(const State &copy):
-    m_mainCar(copy.m_mainCar),
-    m_cars()
+void State::applyTo(Map &m) const
 {
-    for(const auto & car : copy.m_cars) m_cars.push_back(StateCar(car));
+    m.placeState(*this);
 }
 
+int State::carCount() const
+{
+    return m_carCount + 1;
+}
 
-
-void State::applyTo(Map &m)
+const StateCar &State::car(int index) const
 {
-    m.addCar(m_mainCar);
-    for(const auto &car : m_cars) m.addCar(car);
+    return index == 0 ? m_mainCar : m_cars[index - 1];
 }
 
-std::string State::serialize() const
+StateKey State::key(const StateEncoder &encoder) const
 {
-    std::stringstream ss;
-    ss << m_mainCar.toInt7();
+    RUSHHOUR_STATS_PHASE(SERIALIZATION);
+    StateKey packed = KEY_MARKER | (static_cast<StateKey>(m_mainCar.origin - 1) << encoder.shift(0));
+    for(int i = 0; i < m_carCount; ++i) {
+        packed |= static_cast<StateKey>(m_cars[i].origin - 1) << encoder.shift(i + 1);
+    }
+    return packed;
+}
 
-    for(const StateCar &car : m_cars) ss << car.toInt7();
-    return ss.str();
+uint64_t State::rank(const StateEncoder &encoder) const
+{
+    RUSHHOUR_STATS_PHASE(SERIALIZATION);
+    uint64_t rank = static_cast<uint64_t>(m_mainCar.origin - 1);
+    for(int i = 0; i < m_carCount; ++i) {
+        rank += static_cast<uint64_t>(m_cars[i].origin - 1) * encoder.multiplier(i + 1);
+    }
+    return rank;
 }
 
-bool State::isSolutionOf(const Map &m)
+bool State::isSolutionOf(const Map &m) const
 {
     //Is solution if the main car is next to the exit
     /*
      * Could be improved in : is the solution
      * if the space between the exit and the main car is free
      */
-    MapCar carData = m.getCarData(m_mainCar.code);
+    const MapCar &carData = m.getCarData(m_mainCar.code);
     const Point &out = m.exit();
     return carData.originEnd(m_mainCar, 1) == out ||
             carData.otherEnd(m_mainCar) == out;
 }
 
-void State::computeNextCarMove(Map &map, StateCar &car, std::vector<int> &moves)
+void State::successors(Map &map, std::vector<State> &out) const
 {
-    int before = car.origin - 1;
-    if(before > 0){
-        for(int i = 1; i <= before; ++i) {
-            if(map.canMoveCar(car, -i)){
-                moves.push_back(-i);
-            }
+    map.placeState(*this);
+    const Bitboard &occupancy = map.board();
+    State next = *this;
+    RUSHHOUR_STATS_PHASE(MOVE_GENERATION);
+    size_t first = out.size();
+    for(int c = 0; c < carCount(); ++c){
+        StateCar &car = c == 0 ? next.m_mainCar : next.m_cars[c - 1];
+        const CarTrack &track = map.track(car.code);
+        int before = occupancy.freeBefore(track, car.origin);
+        int after = occupancy.freeAfter(track, car.origin);
+        int8 origin = car.origin;
+        for(int i = -before; i <= after; ++i){
+            if(i == 0) continue;
+            car.origin = origin + i;
+            out.push_back(next);
         }
+        car.origin = origin;
     }
-    int after = map.distanceAfter(car);
-    if(after > 0){
-        for(int i = 1; i <= after; ++i){
-            if(map.canMoveCar(car, i)){
-                moves.push_back(i);
-            }
-        }
+    RUSHHOUR_STATS_GENERATED(out.size() - first);
+}
+
+State State::fromKey(StateKey key, const StateEncoder &encoder)
+{
+    State state;
+    for(int i = 0; i < encoder.carCount(); ++i){
+        int origin = static_cast<int>(key >> encoder.shift(i)) & encoder.mask(i);
+        StateCar car(encoder.code(i), origin + 1);
+        if(i == 0) state.m_mainCar = car;
+        else state.m_cars[i - 1] = car;
     }
+    state.m_carCount = encoder.carCount() - 1;
+    return state;
 }
 
-void State::computeNextStates(Map &map, int pred, std::vector<State> &stateQueue, std::unordered_map<int,int> &anc)
+State State::fromRank(uint64_t rank, const StateEncoder &encoder)
 {
-    applyTo(map);
-    std::vector<int> moves;
-    computeNextCarMove(map, m_mainCar, moves);
-    for(int i : moves){
-        m_mainCar.origin += i;
-        if(stateCreated(*this)){
-            State copy = *this;
-            stateQueue.push_back(copy);
-            anc[stateQueue.size() -1] = pred;
-        }
-        m_mainCar.origin -= i;
+    State state;
+    for(int i = 0; i < encoder.carCount(); ++i){
+        int count = encoder.originCount(i);
+        StateCar car(encoder.code(i), static_cast<int>(rank % count) + 1);
+        rank /= count;
+        if(i == 0) state.m_mainCar = car;
+        else state.m_cars[i - 1] = car;
     }
-    for(auto& car : m_cars) {
-        moves.clear();
-        computeNextCarMove(map, car, moves);
-        for(int i : moves){
-            car.origin += i;
-            if(stateCreated(*this)){
-                State copy = *this;
-                stateQueue.push_back(copy);
-                anc[stateQueue.size() -1] = pred;
-            }
-            car.origin -= i;
+    state.m_carCount = encoder.carCount() - 1;
+    return state;
+}
+
+void State::moves(Map &map, std::vector<Move> &out) const
+{
+    map.placeState(*this);
+    const Bitboard &occupancy = map.board();
+    RUSHHOUR_STATS_PHASE(MOVE_GENERATION);
+    size_t first = out.size();
+    for(int c = 0; c < carCount(); ++c){
+        const StateCar &current = car(c);
+        const CarTrack &track = map.track(current.code);
+        int before = occupancy.freeBefore(track, current.origin);
+        int after = occupancy.freeAfter(track, current.origin);
+        for(int i = -before; i <= after; ++i){
+            if(i != 0) out.push_back(Move(c, i));
         }
     }
-    map.reset();
+    RUSHHOUR_STATS_GENERATED(out.size() - first);
 }
 
-bool State::stateCreated(const State &origin)
+void State::play(const Move &move)
 {
-    std::string encoded = origin.serialize();
+    StateCar &moved = move.car == 0 ? m_mainCar : m_cars[move.car - 1];
+    moved.origin += move.distance;
+}
 
-    bool &val = knownStates[encoded];
-    if(val) return false;
-    return (val = true);
+Move State::moveTo(const State &next) const
+{
+    for(int i = 0; i < carCount(); ++i){
+        int8 distance = next.car(i).origin - car(i).origin;
+        if(distance) return Move(i, distance);
+    }
+    return Move();
 }
 
 void State::extractFrom(Map &map)
 {
     for(int y = 1; y < map.height() - 1; ++y){
         for(int x = 1; x < map.width() - 1; ++x){
-            if(map.at(x ,y) != ' ') {
-                StateCar c = map.getCar(x, y);
-                if(c.code == 0){
-                    m_mainCar = c;
-                }else{
-                    m_cars.push_back(c);
-                }
-            }
+            if(map.at(x ,y) != ' ') addCar(map.getCar(x, y));
         }
     }
+    finishCars(map);
+}
+
+void State::addCar(const StateCar &car)
+{
+    // A code met twice is a letter used by two separate cars
+    bool used = car.code == 0 ? m_mainCar.origin != 0 :
+            std::any_of(m_cars.begin(), m_cars.begin() + m_carCount, [&car](const StateCar &other){
+                return other.code == car.code;
+            });
+    if(used){
+        throw std::runtime_error("The letter " + std::string(1, toReadable(car.code)) +
+                                 " is used by two separate cars");
+    }
+    if(car.code == 0){
+        m_mainCar = car;
+    }else if(m_carCount < MAX_CARS - 1){
+        m_cars[m_carCount++] = car;
+    }else{
+        throw std::runtime_error("Too many cars, the solver can't handle more than " +
+                                 std::to_string(MAX_CARS) + " cars");
+    }
+}
+
+void State::finishCars(const Map &map)
+{
+    if(m_mainCar.origin == 0) throw std::runtime_error("The map has no main car 'a'");
+
+    // The packed states and the searches expect the main car
+    // on the line of the exit, facing it
+    const MapCar &mainData = map.getCarData(0);
+    const Point &out = map.exit();
+    bool sideExit = out.x == 0 || out.x == map.width() - 1;
+    bool topExit = out.y == 0 || out.y == map.height() - 1;
+    bool onLine = mainData.orientation == Orientation::HORIZONTAL ?
+                sideExit && mainData.axisValue == out.y :
+                topExit && mainData.axisValue == out.x;
+    if(!onLine) throw std::runtime_error("The main car 'a' must lie on the line of the exit 'z'");
+
+    std::sort(m_cars.begin(), m_cars.begin() + m_carCount, [](const StateCar &a, const StateCar &b){
+        return a.code < b.code;
+    });
 }
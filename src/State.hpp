@@ -7,22 +7,62 @@
 #define STATE_HPP
 
 #include <vector>
-#include <queue>
-#include <memory>
-#include <unordered_map>
 #include <algorithm>
 #include <array>
 #include "Point.hpp"
 #include "Car.hpp"
+#include "StateEncoder.hpp"
 
 class Map;
 class State;
+class Bitboard;
+
+/**
+ * @brief The Move struct a single move of a state :
+ * which car slides, and how far
+ */
+struct Move{
+    /**
+     * @brief Move empty constructor
+     */
+    Move():car(0),distance(0){}
+
+    /**
+     * @brief Move constructor
+     * @param _car index of the car in the state (0 for the main car)
+     * @param _distance the distance to slide (negative to move left or up)
+     */
+    Move(int8 _car, int8 _distance) : car(_car), distance(_distance){}
+
+    /**
+     * @brief toCode encodes the move on 16 bits : the car's index
+     * on the 8 bigger bits, the distance on the 8 smaller ones
+     * @return the encoded move
+     */
+    uint16_t toCode() const
+    {
+        return static_cast<uint16_t>((car << 8) | static_cast<uint8_t>(distance));
+    }
+
+    /**
+     * @brief fromCode decodes a move encoded by toCode
+     * @param code the encoded move
+     * @return the move
+     */
+    static Move fromCode(uint16_t code)
+    {
+        return Move(static_cast<int8>(code >> 8), static_cast<int8>(code & 0xff));
+    }
+
+    int8 car;
+    int8 distance;
+};
 
 
 /**
  * @brief The State class core class of the problem,
  * contains a list of boxes, and the position of the player
- * can be encoded in a 64 bits int to be stored in a map, can apply
+ * can be packed in a key (see StateEncoder) to be stored in a map, can apply
  * itself to a map, or generate itself from a map (and clean the map)
  */
 class State
@@ -33,77 +73,141 @@ public:
      */
     State();
 
-    State(const State &copy);
-
     /**
      * @brief isSolutionOf wether all the boxes of this states
      * are positionned on the targets of the map
      * @param m the map to test on
      * @return
      */
-    bool isSolutionOf(const Map &m);
+    bool isSolutionOf(const Map &m) const;
 
     /**
-     * @brief applyTo puts the boxes and the player into the map
+     * @brief applyTo puts the cars into the map, only the cars
+     * that moved since the last state placed on the map are redrawn
      * @param m the map to fill
      */
-    void applyTo(Map &m);
+    void applyTo(Map &m) const;
+
+    /**
+     * @brief carCount number of cars of this state,
+     * including the main car
+     * @return the number of cars
+     */
+    int carCount() const;
+
+    /**
+     * @brief car accessor to the cars of this state
+     * @param index index of the car, 0 is the main car
+     * @return the car at the given index
+     */
+    const StateCar &car(int index) const;
 
     /**
-     * @brief computeNextStates calculates the next states of this state,
-     * will check in the four cardinal directions if its possible to move,
-     * and if it is, adds the new state ins the vector (used as a queue) and
-     * declares the new state as the successor of the 'pred' state
-     * @param map the map to use to apply the moves and the states
-     * @param pred the index of the predecessor state in the stateQueue vector
-     * @param stateQueue a vector containing all the visited states and the states to visit, is used as a queue
-     * @param anc the map of the ancestors, the key is the successor, the value is the successor
+     * @brief successors lists all the states reachable from this
+     * state in one move, without checking if they were already visited
+     * @param map the map to use to compute the moves, this state is placed on it
+     * @param out the vector the successors are appended to
      */
-    void computeNextStates(Map &map, int pred, std::vector<State> &stateQueue, std::unordered_map<int,int> &anc);
+    void successors(Map &map, std::vector<State> &out) const;
+
+    /**
+     * @brief fromKey rebuilds a state from its packed version
+     * @param key the packed state, given by 'key'
+     * @param encoder the layout of the packed states of the map
+     * @return the state
+     */
+    static State fromKey(StateKey key, const StateEncoder &encoder);
+
+    /**
+     * @brief moves lists all the moves that can be played from this state
+     * @param map the map to use to compute the moves, this state is placed on it
+     * @param out the vector the moves are appended to
+     */
+    void moves(Map &map, std::vector<Move> &out) const;
+
+    /**
+     * @brief play applies the given move to this state
+     * (the map is not changed)
+     * @param move the move to play, must be one given by 'moves'
+     */
+    void play(const Move &move);
+
+    /**
+     * @brief moveTo finds the move leading from this state to the given one
+     * @param next a state reachable from this one in a single move
+     * @return the move to play, a move of distance 0 if the states are the same
+     */
+    Move moveTo(const State &next) const;
 
     /**
      * @brief extractFrom run through the viable positions of the map,
      * to get the player position and the boxes position,
      * cleans the map to remove all the boxes and the player from it
+     * the cars are sorted by code, the order of the packed states.
+     * Throws an exception if the main car is missing or off the line
+     * of the exit, or if a letter is used by two cars
      * @param map the map to clean
      */
     void extractFrom(Map &map);
 
     /**
-     * @brief toInt64 hash function to encode this state to an int 64
-     * @return
+     * @brief addCar adds a car to this state, as extractFrom does for every
+     * car it finds, throws an exception if its code is already used or if
+     * the state has too many cars. finishCars must be called once all the
+     * cars are added
+     * @param car the car, as given by Map::getCar or Map::addCar
      */
-    std::string serialize() const;
+    void addCar(const StateCar &car);
 
-private:
     /**
-     * @brief knownStates a static map to save all the state that
-     * where created, the key is the hash of the state,
-     * the value (boolean) is wether the state was visited,
-     * by default, this boolean is set to false, and when
-     * a new state is created, it will be set to true
+     * @brief finishCars checks the cars added, and sorts them by code,
+     * the order of the packed states. Throws an exception if the main car
+     * is missing or off the line of the exit
+     * @param map the map the cars were added to
      */
-    static std::unordered_map<std::string, bool> knownStates;
+    void finishCars(const Map &map);
 
     /**
-     * @brief stateExists checks if the given state was already created
-     * @param origin the state to check for
-     * @return wether the given state was already created
+     * @brief key packs this state into an integer, by putting the
+     * origin of every car in its field of the layout of the map
+     * @param encoder the layout of the packed states of the map
+     * @return the packed state, never 0
      */
-    bool stateCreated(const State &origin);
+    StateKey key(const StateEncoder &encoder) const;
 
-    void computeNextCarMove(Map &map, StateCar &car, std::vector<int> &moves);
+    /**
+     * @brief rank numbers this state densely, by reading the origins
+     * of the cars as the digits of a mixed-radix number
+     * (see StateEncoder::multiplier), the map must have a rankCount
+     * @param encoder the layout of the states of the map
+     * @return the rank, below encoder.rankCount()
+     */
+    uint64_t rank(const StateEncoder &encoder) const;
 
+    /**
+     * @brief fromRank rebuilds a state from its rank
+     * @param rank the rank, given by 'rank'
+     * @param encoder the layout of the states of the map
+     * @return the state
+     */
+    static State fromRank(uint64_t rank, const StateEncoder &encoder);
 
+private:
     /**
      * @brief m_ppos position of the player
      */
     StateCar m_mainCar;
 
     /**
-     * @brief m_boxes position of the boxes
+     * @brief m_cars position of the other cars, stored inline
+     * so that copying a state never allocates
+     */
+    std::array<StateCar, MAX_CARS - 1> m_cars;
+
+    /**
+     * @brief m_carCount number of cars used in m_cars
      */
-    std::vector<StateCar> m_cars;
+    int8 m_carCount;
 
 };
 
@@ -0,0 +1,57 @@
+#include "StateEncoder.hpp"
+
+#include <stdexcept>
+#include <string>
+
+StateEncoder::StateEncoder():
+    m_codes(),
+    m_originCounts(),
+    m_shifts(),
+    m_masks(),
+    m_multipliers(),
+    m_rankCount(1),
+    m_carCount(0)
+{
+
+}
+
+void StateEncoder::addCar(int8 code, int originCount)
+{
+    if(originCount < 1){
+        throw std::runtime_error("The car " + std::to_string(code) + " has no origin on its track");
+    }
+    if(m_carCount == MAX_CARS){
+        throw std::runtime_error("Too many cars, the solver can't handle more than " +
+                                 std::to_string(MAX_CARS) + " cars");
+    }
+    int index = m_carCount++;
+    while(index > 0 && m_codes[index - 1] > code){
+        m_codes[index] = m_codes[index - 1];
+        m_originCounts[index] = m_originCounts[index - 1];
+        index--;
+    }
+    m_codes[index] = code;
+    m_originCounts[index] = originCount;
+
+    int shift = 0;
+    m_rankCount = 1;
+    for(int i = 0; i < m_carCount; ++i){
+        int width = 0;
+        while((1 << width) < m_originCounts[i]) width++;
+        m_shifts[i] = shift;
+        m_masks[i] = (1u << width) - 1;
+        shift += width;
+
+        m_multipliers[i] = m_rankCount;
+        if(m_rankCount > (uint64_t(1) << 63) / m_originCounts[i]) m_rankCount = 0;
+        else m_rankCount *= m_originCounts[i];
+    }
+    if(shift > 127) throw std::runtime_error("The cars of the map don't fit in a packed state");
+}
+
+int StateEncoder::bits() const
+{
+    if(!m_carCount) return 0;
+    int last = m_carCount - 1;
+    return m_shifts[last] + __builtin_popcount(m_masks[last]);
+}
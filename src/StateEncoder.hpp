@@ -0,0 +1,149 @@
+#ifndef STATEENCODER_HPP
+#define STATEENCODER_HPP
+
+#include <array>
+#include <cstdint>
+#include "Car.hpp"
+#include "StateKey.hpp"
+
+/**
+ * @brief The StateEncoder class the layout of the packed states of a map,
+ * built while the cars are found on the map. The cars are packed in the
+ * order of their codes, which is also their order in the states, and
+ * each one only takes the bits needed by the number of origins its track
+ * allows (a car of length 2 on a 6 cells line has 5 origins : 3 bits).
+ * The code of a car is given by its place in the key, so it is not stored
+ */
+class StateEncoder
+{
+public:
+    /**
+     * @brief StateEncoder constructor, for a map without cars
+     */
+    StateEncoder();
+
+    /**
+     * @brief addCar adds a car to the layout, the fields of the
+     * cars with a greater code are moved to make room for it,
+     * throws an exception if the key can't hold all the cars or the car has no origin
+     * @param code the code of the car
+     * @param originCount number of origins the car can take (from 1 to originCount)
+     */
+    void addCar(int8 code, int originCount);
+
+    /**
+     * @brief carCount number of cars of the layout
+     * @return the number of cars
+     */
+    int carCount() const
+    {
+        return m_carCount;
+    }
+
+    /**
+     * @brief code the code of a car
+     * @param index the index of the car, in the order of the codes
+     * @return the car's code
+     */
+    int8 code(int index) const
+    {
+        return m_codes[index];
+    }
+
+    /**
+     * @brief shift index of the first bit of the car's origin in the key
+     * @param index the index of the car, in the order of the codes
+     * @return the position of the car's field
+     */
+    int shift(int index) const
+    {
+        return m_shifts[index];
+    }
+
+    /**
+     * @brief mask the bits of the car's field, once shifted to the lowest bits
+     * @param index the index of the car, in the order of the codes
+     * @return the mask of the field
+     */
+    uint32_t mask(int index) const
+    {
+        return m_masks[index];
+    }
+
+    /**
+     * @brief bits number of bits used by the cars, the key also has KEY_MARKER set
+     * @return the number of bits of the packed states
+     */
+    int bits() const;
+
+    /**
+     * @brief originCount number of origins a car can take
+     * @param index the index of the car, in the order of the codes
+     * @return the number of origins, from 1 to originCount
+     */
+    int originCount(int index) const
+    {
+        return m_originCounts[index];
+    }
+
+    /**
+     * @brief multiplier weight of a car's origin in the rank of a state : the rank
+     * reads the origins as the digits of a number, the base of every digit being
+     * the number of origins of its car, the first car giving the lowest digit
+     * @param index the index of the car, in the order of the codes
+     * @return the product of the number of origins of the cars before it
+     */
+    uint64_t multiplier(int index) const
+    {
+        return m_multipliers[index];
+    }
+
+    /**
+     * @brief rankCount number of ranks, the product of the number of origins
+     * of all the cars, every state has a rank below it (and many ranks are
+     * states where cars overlap)
+     * @return the number of ranks, 0 if it does not fit in 63 bits
+     */
+    uint64_t rankCount() const
+    {
+        return m_rankCount;
+    }
+
+private:
+    /**
+     * @brief m_codes the code of every car
+     */
+    std::array<int8, MAX_CARS> m_codes;
+
+    /**
+     * @brief m_originCounts the number of origins of every car
+     */
+    std::array<int, MAX_CARS> m_originCounts;
+
+    /**
+     * @brief m_shifts the position of the field of every car
+     */
+    std::array<int, MAX_CARS> m_shifts;
+
+    /**
+     * @brief m_masks the mask of the field of every car
+     */
+    std::array<uint32_t, MAX_CARS> m_masks;
+
+    /**
+     * @brief m_multipliers the weight of the origin of every car in the ranks
+     */
+    std::array<uint64_t, MAX_CARS> m_multipliers;
+
+    /**
+     * @brief m_rankCount number of ranks, 0 if there are too many
+     */
+    uint64_t m_rankCount;
+
+    /**
+     * @brief m_carCount number of cars of the layout
+     */
+    int m_carCount;
+};
+
+#endif // STATEENCODER_HPP
@@ -0,0 +1,39 @@
+#ifndef STATEKEY_HPP
+#define STATEKEY_HPP
+
+#include <cstdint>
+
+/**
+ * @brief StateKey a whole state packed in an integer, every
+ * car takes the bits needed by its number of origins (see
+ * StateEncoder), at most 4 bits, so all the cars of a map fit
+ * in the 127 lowest bits
+ */
+typedef unsigned __int128 StateKey;
+
+/**
+ * @brief KEY_MARKER bit always set in a packed state, so
+ * that a valid key is never 0 (0 marks the empty slots
+ * of the hash tables)
+ */
+const StateKey KEY_MARKER = StateKey(1) << 127;
+
+/**
+ * @brief hashKey mixes the two halves of the key
+ * into a well distributed 64 bits hash
+ * @param key the key to hash
+ * @return the hash of the key
+ */
+inline uint64_t hashKey(StateKey key)
+{
+    uint64_t h = static_cast<uint64_t>(key) ^
+            (static_cast<uint64_t>(key >> 64) * 0x9E3779B97F4A7C15ull);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+#endif // STATEKEY_HPP
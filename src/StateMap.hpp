@@ -0,0 +1,180 @@
+#ifndef STATEMAP_HPP
+#define STATEMAP_HPP
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include "StateKey.hpp"
+#include "SearchStats.hpp"
+
+/**
+ * @brief The StateMap class associates a value to packed states,
+ * works as the StateSet (flat array, open addressing with linear
+ * probing), the values being stored in a second array next to the keys
+ */
+template<typename Value>
+class StateMap
+{
+public:
+    /**
+     * @brief StateMap constructor
+     * @param maxLoadFactor the ratio of used slots above which
+     * the table doubles its capacity (between 0 and 1)
+     * @param initialCapacity the number of slots to start with
+     * (rounded up to a power of two)
+     */
+    explicit StateMap(double maxLoadFactor = 0.5, size_t initialCapacity = 1024):
+        m_keys(),
+        m_values(),
+        m_size(0),
+        m_maxLoadFactor(std::min(std::max(maxLoadFactor, 0.05), 0.95))
+    {
+        size_t capacity = 16;
+        while(capacity < initialCapacity) capacity <<= 1;
+        m_keys.resize(capacity, 0);
+        m_values.resize(capacity);
+    }
+
+    /**
+     * @brief insert adds the key with the given value,
+     * if the key is already there, its value is left untouched
+     * @param key the key to add, must not be 0
+     * @param value the value of the key
+     * @return the value stored for the key (valid until the next insertion),
+     * and wether the key was added
+     */
+    std::pair<Value*, bool> insert(StateKey key, const Value &value)
+    {
+        RUSHHOUR_STATS_PHASE(VISITED_LOOKUP);
+        if(m_size + 1 > m_keys.size() * m_maxLoadFactor) grow();
+        size_t mask = m_keys.size() - 1;
+        size_t slot = hashKey(key) & mask;
+        int probes = 1;
+        while(m_keys[slot]){
+            if(m_keys[slot] == key){
+                RUSHHOUR_STATS_PROBE(probes);
+                return std::make_pair(&m_values[slot], false);
+            }
+            slot = (slot + 1) & mask;
+            probes++;
+        }
+        RUSHHOUR_STATS_PROBE(probes);
+        m_keys[slot] = key;
+        m_values[slot] = value;
+        m_size++;
+        return std::make_pair(&m_values[slot], true);
+    }
+
+    /**
+     * @brief find looks for the value of the key
+     * @param key the key to look for
+     * @return the value of the key, nullptr if the key is not in the map
+     */
+    Value *find(StateKey key)
+    {
+        RUSHHOUR_STATS_PHASE(VISITED_LOOKUP);
+        size_t mask = m_keys.size() - 1;
+        size_t slot = hashKey(key) & mask;
+        int probes = 1;
+        while(m_keys[slot]){
+            if(m_keys[slot] == key){
+                RUSHHOUR_STATS_PROBE(probes);
+                return &m_values[slot];
+            }
+            slot = (slot + 1) & mask;
+            probes++;
+        }
+        RUSHHOUR_STATS_PROBE(probes);
+        return nullptr;
+    }
+
+    /**
+     * @brief find const version of find
+     * @param key the key to look for
+     * @return the value of the key, nullptr if the key is not in the map
+     */
+    const Value *find(StateKey key) const
+    {
+        return const_cast<StateMap*>(this)->find(key);
+    }
+
+    /**
+     * @brief clear removes all the keys, but keeps the memory
+     */
+    void clear()
+    {
+        std::fill(m_keys.begin(), m_keys.end(), 0);
+        m_size = 0;
+    }
+
+    /**
+     * @brief size number of keys in the map
+     * @return the number of keys in the map
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief capacity number of slots of the table
+     * @return the number of slots of the table
+     */
+    size_t capacity() const
+    {
+        return m_keys.size();
+    }
+
+    /**
+     * @brief memoryBytes memory used by the table
+     * @return the memory used in bytes
+     */
+    size_t memoryBytes() const
+    {
+        return m_keys.size() * (sizeof(StateKey) + sizeof(Value));
+    }
+
+private:
+    /**
+     * @brief grow doubles the capacity of the table
+     * and reinserts all the keys
+     */
+    void grow()
+    {
+        std::vector<StateKey> oldKeys(m_keys.size() * 2, 0);
+        std::vector<Value> oldValues(m_values.size() * 2);
+        oldKeys.swap(m_keys);
+        oldValues.swap(m_values);
+        size_t mask = m_keys.size() - 1;
+        for(size_t i = 0; i < oldKeys.size(); ++i){
+            if(!oldKeys[i]) continue;
+            size_t slot = hashKey(oldKeys[i]) & mask;
+            while(m_keys[slot]) slot = (slot + 1) & mask;
+            m_keys[slot] = oldKeys[i];
+            m_values[slot] = oldValues[i];
+        }
+    }
+
+    /**
+     * @brief m_keys the slots of the table, 0 for an empty slot
+     */
+    std::vector<StateKey> m_keys;
+
+    /**
+     * @brief m_values the value of each slot
+     */
+    std::vector<Value> m_values;
+
+    /**
+     * @brief m_size number of keys in the map
+     */
+    size_t m_size;
+
+    /**
+     * @brief m_maxLoadFactor ratio of used slots above which the table grows
+     */
+    double m_maxLoadFactor;
+};
+
+#endif // STATEMAP_HPP
@@ -0,0 +1,87 @@
+#include "StateSet.hpp"
+#include "SearchStats.hpp"
+
+#include <algorithm>
+
+StateSet::StateSet(double maxLoadFactor, size_t initialCapacity):
+    m_keys(),
+    m_size(0),
+    m_maxLoadFactor(0.5)
+{
+    setMaxLoadFactor(maxLoadFactor);
+    size_t capacity = 16;
+    while(capacity < initialCapacity) capacity <<= 1;
+    m_keys.resize(capacity, 0);
+}
+
+bool StateSet::insert(StateKey key)
+{
+    RUSHHOUR_STATS_PHASE(VISITED_LOOKUP);
+    if(m_size + 1 > m_keys.size() * m_maxLoadFactor) grow();
+
+    size_t mask = m_keys.size() - 1;
+    size_t slot = hashKey(key) & mask;
+    int probes = 1;
+    while(m_keys[slot]){
+        if(m_keys[slot] == key){
+            RUSHHOUR_STATS_PROBE(probes);
+            return false;
+        }
+        slot = (slot + 1) & mask;
+        probes++;
+    }
+    RUSHHOUR_STATS_PROBE(probes);
+    m_keys[slot] = key;
+    m_size++;
+    return true;
+}
+
+bool StateSet::contains(StateKey key) const
+{
+    size_t mask = m_keys.size() - 1;
+    size_t slot = hashKey(key) & mask;
+    while(m_keys[slot]){
+        if(m_keys[slot] == key) return true;
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+void StateSet::clear()
+{
+    std::fill(m_keys.begin(), m_keys.end(), 0);
+    m_size = 0;
+}
+
+size_t StateSet::size() const
+{
+    return m_size;
+}
+
+size_t StateSet::capacity() const
+{
+    return m_keys.size();
+}
+
+size_t StateSet::memoryBytes() const
+{
+    return m_keys.size() * sizeof(StateKey);
+}
+
+void StateSet::setMaxLoadFactor(double maxLoadFactor)
+{
+    m_maxLoadFactor = std::min(std::max(maxLoadFactor, 0.05), 0.95);
+}
+
+void StateSet::grow()
+{
+    std::vector<StateKey> old(m_keys.size() * 2, 0);
+    old.swap(m_keys);
+    size_t mask = m_keys.size() - 1;
+    for(StateKey key : old){
+        if(!key) continue;
+        size_t slot = hashKey(key) & mask;
+        while(m_keys[slot]) slot = (slot + 1) & mask;
+        m_keys[slot] = key;
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef STATESET_HPP
+#define STATESET_HPP
+
+#include <vector>
+#include <cstddef>
+#include "StateKey.hpp"
+
+/**
+ * @brief The StateSet class set of packed states, stored
+ * in a single flat array with open addressing (linear probing)
+ * no allocation is made when inserting a key, unless the table
+ * has to grow
+ */
+class StateSet
+{
+public:
+    /**
+     * @brief StateSet constructor
+     * @param maxLoadFactor the ratio of used slots above which
+     * the table doubles its capacity (between 0 and 1)
+     * @param initialCapacity the number of slots to start with
+     * (rounded up to a power of two)
+     */
+    explicit StateSet(double maxLoadFactor = 0.5, size_t initialCapacity = 1024);
+
+    /**
+     * @brief insert adds the key to the set
+     * @param key the key to add, must not be 0
+     * @return true if the key was not already in the set
+     */
+    bool insert(StateKey key);
+
+    /**
+     * @brief contains wether the key is already in the set
+     * @param key the key to look for
+     * @return wether the key is in the set
+     */
+    bool contains(StateKey key) const;
+
+    /**
+     * @brief clear removes all the keys, but keeps the memory
+     */
+    void clear();
+
+    /**
+     * @brief size number of keys in the set
+     * @return the number of keys in the set
+     */
+    size_t size() const;
+
+    /**
+     * @brief capacity number of slots of the table
+     * @return the number of slots of the table
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief memoryBytes memory used by the table
+     * @return the memory used in bytes
+     */
+    size_t memoryBytes() const;
+
+    /**
+     * @brief setMaxLoadFactor changes the ratio of used
+     * slots above which the table grows
+     * @param maxLoadFactor the new maximum load factor
+     */
+    void setMaxLoadFactor(double maxLoadFactor);
+
+private:
+    /**
+     * @brief grow doubles the capacity of the table
+     * and reinserts all the keys
+     */
+    void grow();
+
+    /**
+     * @brief m_keys the slots of the table, 0 for an empty slot
+     */
+    std::vector<StateKey> m_keys;
+
+    /**
+     * @brief m_size number of keys in the set
+     */
+    size_t m_size;
+
+    /**
+     * @brief m_maxLoadFactor ratio of used slots above which the table grows
+     */
+    double m_maxLoadFactor;
+};
+
+#endif // STATESET_HPP
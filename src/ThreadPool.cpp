@@ -0,0 +1,100 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount):
+    m_workers(),
+    m_threads(),
+    m_task(nullptr),
+    m_remaining(0),
+    m_generation(0),
+    m_stopping(false)
+{
+    threadCount = std::max(threadCount, 1);
+    for(int i = 0; i < threadCount; ++i) m_workers.emplace_back(new Worker());
+    for(int i = 0; i < threadCount; ++i) m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for(auto &thread : m_threads) thread.join();
+}
+
+int ThreadPool::size() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+void ThreadPool::run(size_t taskCount, const std::function<void(size_t, int)> &task)
+{
+    if(taskCount == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_remaining = taskCount;
+        size_t workerCount = m_workers.size();
+        size_t block = (taskCount + workerCount - 1) / workerCount;
+        for(size_t w = 0; w < workerCount; ++w){
+            std::lock_guard<std::mutex> workerLock(m_workers[w]->mutex);
+            for(size_t t = w * block; t < std::min(taskCount, (w + 1) * block); ++t){
+                m_workers[w]->tasks.push_back(t);
+            }
+        }
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]{ return m_remaining == 0; });
+}
+
+void ThreadPool::workerLoop(int index)
+{
+    size_t seenGeneration = 0;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]{ return m_stopping || m_generation != seenGeneration; });
+            if(m_stopping) return;
+            seenGeneration = m_generation;
+        }
+
+        size_t task;
+        while(popTask(index, task) || stealTask(index, task)){
+            (*m_task)(task, index);
+            if(m_remaining.fetch_sub(1) == 1){
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done.notify_all();
+            }
+        }
+    }
+}
+
+bool ThreadPool::popTask(int worker, size_t &task)
+{
+    Worker &own = *m_workers[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if(own.tasks.empty()) return false;
+    task = own.tasks.front();
+    own.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::stealTask(int worker, size_t &task)
+{
+    int count = size();
+    for(int i = 1; i < count; ++i){
+        Worker &victim = *m_workers[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(victim.tasks.empty()) continue;
+        task = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
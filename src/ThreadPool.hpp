@@ -0,0 +1,129 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief The ThreadPool class a fixed set of worker threads
+ * running batches of independent tasks.
+ * Each worker has its own queue of tasks, the tasks of a batch
+ * are split evenly between the queues, and a worker that empties
+ * its queue steals tasks from the back of the other queues,
+ * so that the workers stay busy even when the tasks are uneven
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief ThreadPool constructor, starts the workers
+     * @param threadCount the number of workers, at least 1
+     */
+    explicit ThreadPool(int threadCount);
+
+    /**
+     * @brief ~ThreadPool stops and joins all the workers
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief size number of workers of the pool
+     * @return the number of workers
+     */
+    int size() const;
+
+    /**
+     * @brief run executes task(index, worker) for every index
+     * between 0 and taskCount (excluded), and blocks until all the
+     * tasks are done
+     * the worker parameter is the index of the worker executing the task,
+     * so that the tasks can use per-worker data without locking
+     * @param taskCount the number of tasks to run
+     * @param task the function to run
+     */
+    void run(size_t taskCount, const std::function<void(size_t, int)> &task);
+
+private:
+    /**
+     * @brief The Worker struct the queue of tasks of a worker
+     */
+    struct Worker{
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    /**
+     * @brief workerLoop the main function of the worker threads
+     * @param index index of the worker
+     */
+    void workerLoop(int index);
+
+    /**
+     * @brief popTask takes the next task of the worker's own queue
+     * @param worker index of the worker
+     * @param task the task taken
+     * @return wether a task was found
+     */
+    bool popTask(int worker, size_t &task);
+
+    /**
+     * @brief stealTask takes the last task of an other worker's queue
+     * @param worker index of the worker stealing
+     * @param task the task taken
+     * @return wether a task was found
+     */
+    bool stealTask(int worker, size_t &task);
+
+    /**
+     * @brief m_workers the task queue of every worker
+     */
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    /**
+     * @brief m_threads the threads of the workers
+     */
+    std::vector<std::thread> m_threads;
+
+    /**
+     * @brief m_task the function of the current batch
+     */
+    const std::function<void(size_t, int)> *m_task;
+
+    /**
+     * @brief m_mutex protects the batch data and the stop flag
+     */
+    std::mutex m_mutex;
+
+    /**
+     * @brief m_wake notified when a new batch starts, or when stopping
+     */
+    std::condition_variable m_wake;
+
+    /**
+     * @brief m_done notified when the last task of the batch is done
+     */
+    std::condition_variable m_done;
+
+    /**
+     * @brief m_remaining number of tasks of the batch not done yet
+     */
+    std::atomic<size_t> m_remaining;
+
+    /**
+     * @brief m_generation incremented for every batch
+     */
+    size_t m_generation;
+
+    /**
+     * @brief m_stopping set when the pool is destroyed
+     */
+    bool m_stopping;
+};
+
+#endif // THREADPOOL_HPP
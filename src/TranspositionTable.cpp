@@ -0,0 +1,44 @@
+#include "TranspositionTable.hpp"
+
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(size_t megabytes):
+    m_entries(std::max<size_t>(1, (megabytes << 20) / sizeof(Entry)), Entry{0, 0, 0, 0}),
+    m_iteration(0)
+{
+
+}
+
+bool TranspositionTable::alreadyReached(StateKey key, int depth, int iteration)
+{
+    Entry &entry = m_entries[hashKey(key) % m_entries.size()];
+    uint64_t low = static_cast<uint64_t>(key);
+    uint64_t high = static_cast<uint64_t>(key >> 64);
+    if(entry.low == low && entry.high == high && entry.iteration == iteration && entry.depth <= depth){
+        return true;
+    }
+    entry.low = low;
+    entry.high = high;
+    entry.depth = static_cast<uint16_t>(depth);
+    entry.iteration = static_cast<uint16_t>(iteration);
+    return false;
+}
+
+int TranspositionTable::nextIteration()
+{
+    if(++m_iteration == 0){
+        std::fill(m_entries.begin(), m_entries.end(), Entry{0, 0, 0, 0});
+        m_iteration = 1;
+    }
+    return m_iteration;
+}
+
+size_t TranspositionTable::size() const
+{
+    return m_entries.size();
+}
+
+size_t TranspositionTable::memoryBytes() const
+{
+    return m_entries.capacity() * sizeof(Entry);
+}
@@ -0,0 +1,81 @@
+#ifndef TRANSPOSITIONTABLE_HPP
+#define TRANSPOSITIONTABLE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "StateKey.hpp"
+
+/**
+ * @brief The TranspositionTable class fixed-size memory of the
+ * states reached by a depth-first search, used to cut the branches
+ * reaching a state already searched with a lower depth.
+ * Each state has a single possible slot, and a new state simply
+ * replaces the one already there : the memory used never grows,
+ * forgetting a state only costs searching it again
+ */
+class TranspositionTable
+{
+public:
+    /**
+     * @brief TranspositionTable constructor
+     * @param megabytes the memory used by the table
+     */
+    explicit TranspositionTable(size_t megabytes);
+
+    /**
+     * @brief alreadyReached checks if the state was already reached
+     * during the same iteration with a depth lower or equal to the
+     * given one, if it was not, the state is stored with this depth
+     * @param key the state
+     * @param depth the depth of the state in the current path
+     * @param iteration the iteration of the search, given by nextIteration
+     * (the table is logically emptied when the iteration changes)
+     * @return wether the state can be skipped
+     */
+    bool alreadyReached(StateKey key, int depth, int iteration);
+
+    /**
+     * @brief nextIteration numbers a new iteration, the numbers keep growing
+     * from one search to the other so that a table can be reused without
+     * emptying it, it is only emptied when the numbers wrap around
+     * @return the number of the iteration, never 0
+     */
+    int nextIteration();
+
+    /**
+     * @brief size number of slots of the table
+     * @return the number of slots
+     */
+    size_t size() const;
+
+    /**
+     * @brief memoryBytes memory used by the slots of the table
+     * @return the number of bytes
+     */
+    size_t memoryBytes() const;
+
+private:
+    /**
+     * @brief The Entry struct a slot of the table, the key is
+     * split in two halves to keep the entry small
+     */
+    struct Entry{
+        uint64_t low;
+        uint64_t high;
+        uint16_t depth;
+        uint16_t iteration;
+    };
+
+    /**
+     * @brief m_entries the slots of the table
+     */
+    std::vector<Entry> m_entries;
+
+    /**
+     * @brief m_iteration the number of the last iteration, 0 before the first one
+     */
+    uint16_t m_iteration;
+};
+
+#endif // TRANSPOSITIONTABLE_HPP
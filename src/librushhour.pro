@@ -0,0 +1,8 @@
+
+QT              -= gui core
+CONFIG          += c++17 thread staticlib
+QMAKE_CXXFLAGS  += -std=c++17
+TEMPLATE        = lib
+TARGET          = rushhour
+
+include(rushhour.pri)
@@ -0,0 +1,60 @@
+INCLUDEPATH     += $$PWD
+
+# The search counters (--stats, --trace) are compiled out with CONFIG+=nostats
+!nostats: DEFINES += RUSHHOUR_STATS
+
+SOURCES += $$PWD/Batch.cpp \
+            $$PWD/Bitboard.cpp \
+            $$PWD/Car.cpp \
+            $$PWD/DistanceTable.cpp \
+            $$PWD/ExternalSearch.cpp \
+            $$PWD/FixedSearch.cpp \
+            $$PWD/FreeRuns.cpp \
+            $$PWD/FrontierSearch.cpp \
+            $$PWD/Generator.cpp \
+            $$PWD/Heuristic.cpp \
+            $$PWD/HintSession.cpp \
+            $$PWD/Map.cpp \
+            $$PWD/PuzzlePack.cpp \
+            $$PWD/RankedSearch.cpp \
+            $$PWD/Search.cpp \
+            $$PWD/SearchStats.cpp \
+            $$PWD/SearchTree.cpp \
+            $$PWD/Server.cpp \
+            $$PWD/SolutionDatabase.cpp \
+            $$PWD/Solver.cpp \
+            $$PWD/State.cpp \
+            $$PWD/StateEncoder.cpp \
+            $$PWD/StateSet.cpp \
+            $$PWD/ThreadPool.cpp \
+            $$PWD/TranspositionTable.cpp
+
+HEADERS += \
+           $$PWD/Batch.hpp \
+           $$PWD/Bitboard.hpp \
+           $$PWD/Car.hpp \
+           $$PWD/DistanceTable.hpp \
+           $$PWD/ExternalSearch.hpp \
+           $$PWD/FixedSearch.hpp \
+           $$PWD/FreeRuns.hpp \
+           $$PWD/FrontierSearch.hpp \
+           $$PWD/Generator.hpp \
+           $$PWD/Heuristic.hpp \
+           $$PWD/HintSession.hpp \
+           $$PWD/Map.hpp \
+           $$PWD/Point.hpp \
+           $$PWD/PuzzlePack.hpp \
+           $$PWD/RankedSearch.hpp \
+           $$PWD/Search.hpp \
+           $$PWD/SearchStats.hpp \
+           $$PWD/SearchTree.hpp \
+           $$PWD/Server.hpp \
+           $$PWD/SolutionDatabase.hpp \
+           $$PWD/Solver.hpp \
+           $$PWD/State.hpp \
+           $$PWD/StateEncoder.hpp \
+           $$PWD/StateKey.hpp \
+           $$PWD/StateMap.hpp \
+           $$PWD/StateSet.hpp \
+           $$PWD/ThreadPool.hpp \
+           $$PWD/TranspositionTable.hpp